@@ -22,12 +22,26 @@
 #include "osSemaphore.h"
 #include "osQueue.h"
 #include "osIRQ.h"
-
-osTaskObject task1ctrl;
-osTaskObject task2ctrl;
-osTaskObject task3ctrl;
-osTaskObject task4ctrl;
-osTaskObject task5ctrl;
+#include "osWorkQueue.h"
+#include "osBenchmark.h"
+
+/* Each stack is sized for its task, with OS_USE_CCMRAM they are placed in CCM RAM */
+osTaskObject task1ctrl OS_CCMRAM;
+osTaskObject task2ctrl OS_CCMRAM;
+osTaskObject task3ctrl OS_CCMRAM;
+osTaskObject task4ctrl OS_CCMRAM;
+osTaskObject task5ctrl OS_CCMRAM;
+OS_TASK_STACK_DEFINE(task1Stack, 192) OS_CCMRAM;
+OS_TASK_STACK_DEFINE(task2Stack, 192) OS_CCMRAM;
+OS_TASK_STACK_DEFINE(task3Stack, 128) OS_CCMRAM;
+OS_TASK_STACK_DEFINE(task4Stack, 128) OS_CCMRAM;
+OS_TASK_STACK_DEFINE(task5Stack, 192) OS_CCMRAM;
+#if OS_USE_BENCHMARK
+osTaskObject benchCtrl;
+OS_TASK_STACK_DEFINE(benchStack, 512);
+osBenchTimerResult benchTimer;
+volatile float benchFpu;
+#endif
 
 
 /* Private includes ----------------------------------------------------------*/
@@ -60,15 +74,20 @@ osTaskObject task5ctrl;
 void SystemClock_Config(void);
 static void MX_GPIO_Init(void);
 void toggleLed(void* p);
-void taskTriggerIRQ(void);
-
-static void task1(void);
-static void task2(void);
-static void task3(void);
-static void task4(void);
-//void task5(void);
+static void toggleLedWork(void* arg);
+void taskTriggerIRQ(void* arg);
+
+static void task1(void* arg);
+static void task2(void* arg);
+static void task3(void* arg);
+static void task4(void* arg);
+//void task5(void* arg);
+#if OS_USE_BENCHMARK
+static void taskBenchmark(void* arg);
+#endif
 osSemaphoreObject semaphore;
 osQueueObject queue;
+osWorkObject ledWork;
 /* USER CODE BEGIN PFP */
 
 /* USER CODE END PFP */
@@ -110,25 +129,38 @@ int main(void)
 
 
 
-	ret = osTaskCreate(&task1ctrl, OS_VERYHIGH_PRIORITY, task1);
+	/* The queue and semaphore used by each task are given as argument */
+	ret = osTaskCreatePeriodic(&task1ctrl, 1000, 0, 10, task1, &queue, OS_TASK_STACK(task1Stack));   // Every second, priority from the period
 	if (ret != true) Error_Handler();
-	ret = osTaskCreate(&task2ctrl, OS_VERYHIGH_PRIORITY, task2);
+	ret = osTaskCreate(&task2ctrl, OS_VERYHIGH_PRIORITY, task2, &queue, OS_TASK_STACK(task2Stack));
 	if (ret != true) Error_Handler();
-	ret = osTaskCreate(&task3ctrl, OS_HIGH_PRIORITY, task3);
+	ret = osTaskCreate(&task3ctrl, OS_HIGH_PRIORITY, task3, &semaphore, OS_TASK_STACK(task3Stack));
 	if (ret != true) Error_Handler();
-	ret = osTaskCreate(&task4ctrl, OS_LOW_PRIORITY, task4);
+	ret = osTaskCreate(&task4ctrl, OS_LOW_PRIORITY, task4, &semaphore, OS_TASK_STACK(task4Stack));
 	if (ret != true) Error_Handler();
-//	ret = osTaskCreate(&task5ctrl, OS_NORMAL_PRIORITY, task5);
+//	ret = osTaskCreate(&task5ctrl, OS_NORMAL_PRIORITY, task5, NULL, OS_TASK_STACK(task5Stack));
 //	if (ret != true) Error_Handler();
 
-//  ret = osTaskCreate(&task5ctrl, OS_NORMAL_PRIORITY, taskTriggerIRQ);
+//  ret = osTaskCreate(&task5ctrl, OS_NORMAL_PRIORITY, taskTriggerIRQ, NULL, OS_TASK_STACK(task5Stack));
 //  if (ret != true) Error_Handler();
 
+#if OS_USE_BENCHMARK
+  ret = osTaskCreate(&benchCtrl, OS_VERYHIGH_PRIORITY, taskBenchmark, NULL, OS_TASK_STACK(benchStack));
+  if (ret != true) Error_Handler();
+#endif
+
   /* The implementation is for binary semaphores */
   osSemaphoreInit(&semaphore, 1, 0);
   osQueueInit(&queue, sizeof(uint32_t));
 
-  uint8_t pin = GPIO_PIN_1;
+  /* The GPIO work of the IRQs is deferred to the worker task */
+  ret = osWorkQueueInit(OS_HIGH_PRIORITY);
+  if (ret != true) Error_Handler();
+  ret = osWorkQueueSetServer(2, 10, OS_BUDGET_SPORADIC);   // At most 20% of the CPU for the IRQ work
+  if (ret != true) Error_Handler();
+  osWorkInit(&ledWork, toggleLedWork, NULL);
+
+  static uint8_t pin = GPIO_PIN_1;          // osStart reuses the stack of main
 
   osRegisterIRQ(EXTI1_IRQn, toggleLed, &pin);
 
@@ -152,12 +184,17 @@ void toggleLed(void* p)
 	uint8_t pin = *(uint8_t *)p;
 	if(pin == GPIO_PIN_1)
 	{
-		HAL_GPIO_TogglePin(LD3_GPIO_Port, LD3_Pin);
 		__HAL_GPIO_EXTI_CLEAR_IT(pin);
+		osWorkSubmit(&ledWork);
 	}
 }
 
-void taskTriggerIRQ(void)
+static void toggleLedWork(void* arg)
+{
+	HAL_GPIO_TogglePin(LD3_GPIO_Port, LD3_Pin);
+}
+
+void taskTriggerIRQ(void* arg)
 {
 	while(1)
 	{
@@ -167,47 +204,48 @@ void taskTriggerIRQ(void)
 	}
 }
 
-static void task1(void)
+/* Job of a periodic task, the kernel calls it once per period */
+static void task1(void* arg)
 {
-    uint32_t i = 0;
-    uint32_t data = 32;
+    osQueueObject* q = (osQueueObject*)arg;
+    static uint32_t i = 0;
+    static uint32_t data = 32;
 
-    while(1)
-    {
-    	osQueueSend(&queue, &data, MAX_DELAY);
-    	i++;
-    	data += i;
-    	osDelay(1000);
-    }
+    osQueueSend(q, &data, MAX_DELAY);
+    i++;
+    data += i;
 }
 
-static void task2(void)
+static void task2(void* arg)
 {
+    osQueueObject* q = (osQueueObject*)arg;
     uint32_t j = 0;
     uint32_t data = 0;
 
     while(1)
     {
         data = 0;
-        osQueueReceive(&queue, &data, MAX_DELAY);
+        osQueueReceive(q, &data, MAX_DELAY);
     	j++;
 
     }
 }
 
-static void task3(void)
+static void task3(void* arg)
 {
+    osSemaphoreObject* sem = (osSemaphoreObject*)arg;
     uint32_t k = 0;
 
     while(1)
     {
-    	osSemaphoreTake(&semaphore);
+    	osSemaphoreTake(sem);
     	k++;
     }
 }
 
-static void task4(void)
+static void task4(void* arg)
 {
+    osSemaphoreObject* sem = (osSemaphoreObject*)arg;
     uint32_t m = 0;
 
     while(1)
@@ -216,12 +254,32 @@ static void task4(void)
 
         if (m%10 == 0)
         {
-        	osSemaphoreGive(&semaphore);
+        	osSemaphoreGive(sem);
         }
     }
 }
 
 
+#if OS_USE_BENCHMARK
+static void taskBenchmark(void* arg)
+{
+    /* Results are left in the bench* variables to be read with the debugger */
+    osBenchTimerWheel(&benchTimer);
+
+    /*
+     * From here the osBenchPendSV counters accumulate the context switches of the application.
+     * This task keeps FPU context and the other ones are integer only, so osBenchPendSVFpu and
+     * osBenchPendSVInt give the cost of the switches with and without the FPU registers.
+     */
+    osBenchPendSVReset();
+
+    while(1)
+    {
+        benchFpu = benchFpu * 0.5f + 1.0f;
+        osDelay(1);
+    }
+}
+#endif
 
 /**
   * @brief System Clock Configuration
@@ -46,6 +46,8 @@ static uint8_t *__sbrk_heap_end = NULL;
  * The implementation considers '_estack' linker symbol to be RAM end
  * NOTE: If the MSP stack, at any point during execution, grows larger than the
  * reserved size, please increase the '_Min_Stack_Size'.
+ * NOTE: With OS_USE_HEAP enabled newlib malloc/free are served by the kernel
+ * TLSF heap (OS/Src/osHeap.c) and this function is not used.
  *
  * @param incr Memory size
  * @return Pointer to allocated memory
@@ -43,6 +43,16 @@ defined in linker script */
 .word  _sbss
 /* end address for the .bss section. defined in linker script */
 .word  _ebss
+/* start address for the initialization values of the .ccmram section. defined in linker script */
+.word  _siccmram
+/* start address for the .ccmram section. defined in linker script */
+.word  _sccmram
+/* end address for the .ccmram section. defined in linker script */
+.word  _eccmram
+/* start address for the .ccmbss section. defined in linker script */
+.word  _sccmbss
+/* end address for the .ccmbss section. defined in linker script */
+.word  _eccmbss
 /* stack used for SystemInit_ExtMemCtl; always internal RAM used */
 
 /**
@@ -91,6 +101,37 @@ LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
 
+/* Copy the ccmram segment initializers from flash to CCMRAM */
+  ldr r0, =_sccmram
+  ldr r1, =_eccmram
+  ldr r2, =_siccmram
+  movs r3, #0
+  b LoopCopyCcmramInit
+
+CopyCcmramInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyCcmramInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyCcmramInit
+
+/* Zero fill the ccmbss segment. */
+  ldr r2, =_sccmbss
+  ldr r4, =_eccmbss
+  movs r3, #0
+  b LoopFillZeroCcmbss
+
+FillZeroCcmbss:
+  str  r3, [r2]
+  adds r2, r2, #4
+
+LoopFillZeroCcmbss:
+  cmp r2, r4
+  bcc FillZeroCcmbss
+
 /* Call the clock system initialization function.*/
   bl  SystemInit   
 /* Call static constructors */
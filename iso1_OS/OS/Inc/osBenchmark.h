@@ -0,0 +1,126 @@
+#ifndef INC_OSBENCHMARK_H
+#define INC_OSBENCHMARK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "osKernel.h"
+
+#if OS_USE_BENCHMARK
+
+/*
+ * Cycle measurements of the kernel paths with the DWT cycle counter.
+ * Enable it with OS_USE_BENCHMARK = 1 and run the benchmarks from a task, the results are
+ * left in the structures passed by the user so they can be read with the debugger.
+ */
+
+#define OS_BENCH_TIMERS         10000U      // Arm and cancel operations of the timer benchmark
+#define OS_BENCH_TIMER_POOL     1000U       // Timers armed at the same time (limited by the RAM)
+#define OS_BENCH_TICKS          100U        // Ticks sampled on each SysTick measurement
+
+/**
+ * @brief Accumulated cycles of a measured path.
+ */
+typedef struct
+{
+    u32 last;
+    u32 min;
+    u32 max;
+    u32 samples;
+    uint64_t total;
+}osBenchCounter;
+
+/**
+ * @brief Result of osBenchTimerWheel.
+ */
+typedef struct
+{
+    u32 operations;             // Arm and cancel operations done
+    u32 armed;                  // Timers armed while measuring tickLoaded
+    u32 expired;                // Timers that expired during the benchmark
+    osBenchCounter arm;         // osTimerStart
+    osBenchCounter cancel;      // osTimerStop
+    osBenchCounter tickIdle;    // SysTick_Handler without timers armed
+    osBenchCounter tickLoaded;  // SysTick_Handler with OS_BENCH_TIMER_POOL timers armed
+}osBenchTimerResult;
+
+/**
+ * @brief SysTick_Handler cycles, updated by the kernel on every tick.
+ */
+extern osBenchCounter osBenchSysTick;
+
+/**
+ * @brief PendSV_Handler cycles (context switch), updated by the kernel on every switch.
+ * Build with and without OS_USE_MPU_STACK_GUARD to get the cost of the guard.
+ */
+extern osBenchCounter osBenchPendSV;
+
+/**
+ * @brief PendSV_Handler cycles split by FPU use: osBenchPendSVFpu when the outgoing or the incoming
+ * task has FPU context (s16-s31 saved or restored), osBenchPendSVInt when both are integer only.
+ */
+extern osBenchCounter osBenchPendSVFpu;
+extern osBenchCounter osBenchPendSVInt;
+
+/**
+ * @brief Cycles from the call to osStart until the first task is entered.
+ */
+extern u32 osBenchStartup;
+
+/**
+ * @brief Enable the DWT cycle counter.
+ */
+void osBenchInit(void);
+
+/**
+ * @brief Current value of the cycle counter.
+ */
+static inline u32 osBenchCycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Clear a counter.
+ */
+void osBenchCounterReset(osBenchCounter* counter);
+
+/**
+ * @brief Add a sample to a counter.
+ */
+void osBenchCounterAdd(osBenchCounter* counter, const u32 cycles);
+
+/**
+ * @brief Average of the samples of a counter.
+ */
+u32 osBenchCounterAverage(const osBenchCounter* counter);
+
+/**
+ * @brief Used by PendSV_Handler to measure itself.
+ *
+ * @param[in]   excReturn   EXEC_RETURN of the outgoing (start) and incoming (end) task.
+ */
+void osBenchPendSVStart(const u32 excReturn);
+void osBenchPendSVEnd(const u32 excReturn);
+
+/**
+ * @brief Clear the PendSV_Handler counters.
+ */
+void osBenchPendSVReset(void);
+
+/**
+ * @brief Arm and cancel OS_BENCH_TIMERS timers and measure the per-tick SysTick_Handler cost
+ * with and without timers armed. Must be called from a task.
+ *
+ * @param[out]  result  Measurements.
+ */
+void osBenchTimerWheel(osBenchTimerResult* result);
+
+#endif // OS_USE_BENCHMARK
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_OSBENCHMARK_H
@@ -0,0 +1,163 @@
+#ifndef INC_OSCONFIG_H
+#define INC_OSCONFIG_H
+
+/*
+ * Compile-time configuration of the OS.
+ * Every value can be changed here or overridden from the build (-DOS_MAX_TASKS=24 ...).
+ * The kernel tables (task list, ready lists and ready bitmap, time slices) are sized from them.
+ */
+
+/*
+ * Scheduler:
+ *  OS_WITH_PRIORITY: fixed priority with round-robin inside each level
+ *  OS_WITH_EDF:      earliest deadline first for the tasks with deadline (periodic tasks, osTaskSetDeadline),
+ *                    the tasks without deadline run by fixed priority when none of them is ready
+ *  OS_WITH_TIME_PARTITION: cyclic table of minor frames (OS_PARTITION_TABLE), each one gives the CPU
+ *                    to one partition and its tasks are scheduled by fixed priority inside it
+ *  OS_SIMPLE:        round-robin
+ * Each one is a policy source file (osSched*.c), see osSched.h.
+ */
+#if !defined(OS_SIMPLE) && !defined(OS_WITH_PRIORITY) && !defined(OS_WITH_EDF) && !defined(OS_WITH_TIME_PARTITION)
+#define OS_WITH_PRIORITY
+#endif
+#if (defined(OS_SIMPLE) + defined(OS_WITH_PRIORITY) + defined(OS_WITH_EDF) + defined(OS_WITH_TIME_PARTITION)) > 1
+#error "Select only one scheduler: OS_SIMPLE, OS_WITH_PRIORITY, OS_WITH_EDF or OS_WITH_TIME_PARTITION"
+#endif
+
+/* Tasks and priorities --------------------------------------------------------*/
+#ifndef OS_MAX_TASKS
+#define OS_MAX_TASKS            8U          // Tasks that can be created by the application, IDLE is not counted
+#endif
+
+#ifndef OS_MAX_PRIORITY
+#define OS_MAX_PRIORITY         4U          // Priority levels, 1 to 32. 0 is the highest, OS_MAX_PRIORITY - 1 the lowest
+#endif
+
+/*
+ * Round-robin quantum in ticks between tasks of the same priority, per level (see osTaskSetTimeSlice).
+ * The named levels (OS_VERYHIGH_PRIORITY ... OS_LOW_PRIORITY) can have their own one by defining
+ * OS_TIME_SLICE_VERYHIGH, OS_TIME_SLICE_HIGH, OS_TIME_SLICE_NORMAL or OS_TIME_SLICE_LOW.
+ * Every level can be set with OS_TIME_SLICE_TABLE, one entry per level from 0 (the highest) to
+ * OS_MAX_PRIORITY - 1: with 8 levels, -DOS_TIME_SLICE_TABLE="{1U, 1U, 2U, 2U, 5U, 5U, 10U, 10U}".
+ * The table replaces the other values, and it must have exactly OS_MAX_PRIORITY entries.
+ */
+#ifndef OS_TIME_SLICE
+#define OS_TIME_SLICE           1U          // Default of every level. 1 rotates on every tick
+#endif
+
+/* Time partitions: {partition, ticks} of every minor frame, the table is repeated from osStart. Frames of 0 ticks are rejected by osStart */
+#ifdef OS_WITH_TIME_PARTITION
+#ifndef OS_PARTITIONS
+#define OS_PARTITIONS           2U          // Partitions, tasks are assigned with osTaskSetPartition
+#endif
+#ifndef OS_PARTITION_TABLE
+#define OS_PARTITION_TABLE      { {0U, 5U}, {1U, 5U} }
+#endif
+#else
+#undef  OS_PARTITIONS
+#define OS_PARTITIONS           1U
+#endif
+#define OS_PARTITION_NONE       0xFFU       // Minor frame without partition, only IDLE runs
+
+/* Periodic tasks: fixed priorities from the periods, shorter period higher priority (see osTaskCreatePeriodic). Not used by EDF */
+#ifndef OS_USE_RATE_MONOTONIC
+#define OS_USE_RATE_MONOTONIC   1
+#endif
+#ifndef OS_RM_HIGHEST_PRIORITY
+#define OS_RM_HIGHEST_PRIORITY  0U          // Priority of the periodic task with the shortest period
+#endif
+#ifndef OS_RM_LOWEST_PRIORITY
+#define OS_RM_LOWEST_PRIORITY   (OS_MAX_PRIORITY - 1U) // The longest periods share this one when there are more periods than levels
+#endif
+
+#ifndef OS_USE_ADMISSION_CONTROL
+#define OS_USE_ADMISSION_CONTROL 1          // 1: osTaskCreatePeriodic rejects the tasks that make the set unschedulable (not with OS_SIMPLE nor OS_WITH_TIME_PARTITION)
+#endif
+
+/* Execution time budgets (see osTaskSetBudget) */
+#ifndef OS_BUDGET_MAX_REPLENISH
+#define OS_BUDGET_MAX_REPLENISH 4U          // Pending replenishments of a sporadic server, more are merged into the last one
+#endif
+
+/* Stacks ----------------------------------------------------------------------*/
+#ifndef OS_DEFAULT_STACK_SIZE
+#define OS_DEFAULT_STACK_SIZE   256U        // Stack size in bytes of the tasks created by the OS
+#endif
+
+#ifndef OS_MIN_STACK_SIZE
+#define OS_MIN_STACK_SIZE       128U        // Smallest stack accepted by osTaskCreate
+#endif
+
+#ifndef OS_IDLE_STACK_SIZE
+#define OS_IDLE_STACK_SIZE      OS_MIN_STACK_SIZE // Tasks run on PSP, the IRQs don't use the task stacks
+#endif
+
+#ifndef OS_WORKQUEUE_STACK_SIZE
+#define OS_WORKQUEUE_STACK_SIZE 512U        // Stack of the worker task, the work functions run on it
+#endif
+
+/* Tick ------------------------------------------------------------------------*/
+#ifndef OS_SYSTICK_TICK
+#define OS_SYSTICK_TICK         1000U       // Ticks per second
+#endif
+
+/* Features --------------------------------------------------------------------*/
+#ifndef OS_USE_BENCHMARK
+#define OS_USE_BENCHMARK        0           // 1: measure kernel paths with the DWT cycle counter (see osBenchmark.h)
+#endif
+
+#ifndef OS_USE_MPU_STACK_GUARD
+#define OS_USE_MPU_STACK_GUARD  0           // 1: no-access MPU region below the stack of the running task, overflows fault at once
+#endif
+
+#ifndef OS_USE_STACK_CHECK
+#define OS_USE_STACK_CHECK      (!OS_USE_MPU_STACK_GUARD) // 1: check the stack canary of the task on every context switch
+#endif
+
+#ifndef OS_USE_POOL_CHECK
+#ifdef DEBUG
+#define OS_USE_POOL_CHECK       1           // 1: osPoolFree rejects a block that is already free (walks the free list, O(blockCount))
+#else
+#define OS_USE_POOL_CHECK       0
+#endif
+#endif
+
+#ifndef OS_USE_HEAP
+#define OS_USE_HEAP             1           // 1: TLSF heap of the kernel, newlib malloc/free are routed to it (see osHeap.h)
+#endif
+
+/*
+ * Default region of the heap, reserved in SRAM (.bss) whether it is used or not. An application that
+ * gives its own region with osHeapInit (CCM RAM, external RAM...) sets it to 0 to not reserve it, then
+ * the allocations fail until osHeapInit is called.
+ */
+#ifndef OS_HEAP_SIZE
+#define OS_HEAP_SIZE            (32U * 1024U) // Size of the default region of the heap in bytes, 0 for none
+#endif
+
+#ifndef OS_USE_CCMRAM
+#define OS_USE_CCMRAM           0           // 1: kernel control structures and task stacks declared with OS_CCMRAM go to CCM RAM
+#endif
+
+/* Checks ----------------------------------------------------------------------*/
+#if (OS_MAX_PRIORITY < 1) || (OS_MAX_PRIORITY > 32)
+#error "OS_MAX_PRIORITY must be between 1 and 32, the ready bitmap is one word"
+#endif
+
+#if (OS_MAX_TASKS < 1) || (OS_MAX_TASKS > 254)
+#error "OS_MAX_TASKS must be between 1 and 254"
+#endif
+
+#if (OS_RM_HIGHEST_PRIORITY > OS_RM_LOWEST_PRIORITY) || (OS_RM_LOWEST_PRIORITY >= OS_MAX_PRIORITY)
+#error "OS_RM_HIGHEST_PRIORITY..OS_RM_LOWEST_PRIORITY must be a range of valid priorities"
+#endif
+
+#if (OS_PARTITIONS < 1) || (OS_PARTITIONS > 254)
+#error "OS_PARTITIONS must be between 1 and 254"
+#endif
+
+#if (OS_MIN_STACK_SIZE < 72)
+#error "OS_MIN_STACK_SIZE must hold at least the first context of a task (68 bytes)"
+#endif
+
+#endif // INC_OSCONFIG_H
@@ -0,0 +1,94 @@
+#ifndef INC_OSHEAP_H
+#define INC_OSHEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Real-time heap with the TLSF (Two-Level Segregated Fit) algorithm.
+ *
+ * Free blocks are kept in lists indexed by two levels: the first level is the power of two of the
+ * size, the second level splits every power of two in OS_HEAP_SL_COUNT ranges. A bitmap per level
+ * tells which lists have blocks, so finding a suitable block is a couple of CLZ instructions and
+ * malloc/free are O(1) in the worst case.
+ *
+ * When OS_USE_HEAP is enabled newlib malloc/free/calloc/realloc and the __malloc_lock hooks are
+ * routed to this heap, so _sbrk is not used anymore.
+ */
+#define OS_HEAP_ALIGN           8U                              // Alignment of the returned memory
+#define OS_HEAP_SL_LOG2         4U                              // log2 of the second level lists
+#define OS_HEAP_SL_COUNT        (1U << OS_HEAP_SL_LOG2)
+#define OS_HEAP_FL_SHIFT        (OS_HEAP_SL_LOG2 + 3U)          // Sizes below 2^FL_SHIFT use the first list only
+#define OS_HEAP_FL_MAX          18U                             // Biggest block is 2^FL_MAX - 1 bytes (256K)
+#define OS_HEAP_FL_COUNT        (OS_HEAP_FL_MAX - OS_HEAP_FL_SHIFT + 1U)
+
+/**
+ * @brief Heap statistics.
+ */
+typedef struct
+{
+    uint32_t    totalSize;      // Bytes managed by the heap (headers included)
+    uint32_t    usedSize;       // Bytes allocated now (headers included)
+    uint32_t    peakUsed;       // Maximum of usedSize
+    uint32_t    freeSize;       // Bytes available in free blocks
+    uint32_t    largestFree;    // Biggest allocation that could succeed now
+    uint32_t    freeBlocks;     // Number of free blocks
+    uint32_t    allocations;    // Blocks allocated now
+    uint32_t    failures;       // Allocations that returned NULL
+    uint32_t    fragmentation;  // 0 - 100: 100 * (1 - largestFree / freeSize)
+}osHeapStats;
+
+/**
+ * @brief Give a memory region to the heap. Everything allocated before is lost.
+ * If it is not called the heap is created on the first allocation with the
+ * OS_HEAP_SIZE bytes region of the kernel. With OS_HEAP_SIZE 0 there is no such region
+ * and every allocation fails until it is called.
+ *
+ * @param[in]   region  Start of the region.
+ * @param[in]   size    Size of the region in bytes.
+ *
+ * @return Returns true if was success in otherwise false.
+ */
+bool osHeapInit(void* region, const uint32_t size);
+
+/**
+ * @brief Allocate memory. Can be called from IRQs.
+ *
+ * @param[in]   size    Bytes requested.
+ *
+ * @return Returns the memory aligned to OS_HEAP_ALIGN or NULL.
+ */
+void* osHeapAlloc(const uint32_t size);
+
+/**
+ * @brief Give back memory returned by osHeapAlloc. Can be called from IRQs.
+ */
+void osHeapFree(void* ptr);
+
+/**
+ * @brief Resize an allocation, grows in place when the next block is free.
+ */
+void* osHeapRealloc(void* ptr, const uint32_t size);
+
+/**
+ * @brief Usable size of an allocation.
+ */
+uint32_t osHeapUsableSize(const void* ptr);
+
+/**
+ * @brief Read the heap statistics.
+ *
+ * @param[out]  stats   Statistics.
+ */
+void osHeapGetStats(osHeapStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_OSHEAP_H
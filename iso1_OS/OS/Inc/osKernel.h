@@ -36,23 +36,25 @@ extern "C" {
 #include "stdbool.h"
 #include "core_cm4.h"
 #include "cmsis_gcc.h"
+#include "osConfig.h"
 #include "osSemaphore.h"
 #include "osQueue.h"
+#include "osTimer.h"
+#include "osPool.h"
 
 
 
 /* Exported macro ------------------------------------------------------------*/
-#define OS_MAX_TASKS            9 		    // MAX TASKS 8 + IDLE
-#define OS_MAX_STACK_SIZE       256
-#define OS_MAX_PRIORITY         4U          // Defines the maximum amount of priority.
+#define OS_STACK_FILL_PATTERN   0xA5A5A5A5  // Stacks are painted with this value to measure their use
 #define OS_MAX_TASK_NAME_CHAR   10
 #define OS_STACK_FRAME_SIZE     17
-#define OS_SYSTICK_TICK         1000        // In milliseconds
-#define MAX_DELAY               0xFFFFFFFF
+#define MAX_DELAY               0xFFFFFFFF  // Wait forever on blocking APIs
 
 /* Bits positions on Stack Frame */
 #define XPSR_VALUE              1 << 24     // xPSR.T = 1
-#define EXEC_RETURN_VALUE       0xFFFFFFF9  // EXEC_RETURN value. Return to thread mode with MSP, not use FPU
+#define EXEC_RETURN_VALUE       0xFFFFFFFD  // EXEC_RETURN value. Return to thread mode with PSP, not use FPU
+#define EXEC_RETURN_FPU_MSK     (1U << 4)   // EXEC_RETURN[4] = 0: extended frame with the FPU registers
+#define OS_FPU_CONTEXT_SIZE     136U        // Extra stack of a task that uses the FPU: s0-s15, FPSCR, reserved and s16-s31
 #define XPSR_REG_POSITION       1
 #define PC_REG_POSTION          2
 #define LR_REG_POSTION          3
@@ -62,23 +64,47 @@ extern "C" {
 #define R1_REG_POSTION          7
 #define R0_REG_POSTION          8
 #define LR_PREV_VALUE_POSTION   9
-#define R4_REG_POSTION          10
-#define R5_REG_POSTION          11
-#define R6_REG_POSTION          12
-#define R7_REG_POSTION          13
-#define R8_REG_POSTION          14
-#define R9_REG_POSTION          15
-#define R10_REG_POSTION         16
-#define R11_REG_POSTION         17
+#define R11_REG_POSTION         10
+#define R10_REG_POSTION         11
+#define R9_REG_POSTION          12
+#define R8_REG_POSTION          13
+#define R7_REG_POSTION          14
+#define R6_REG_POSTION          15
+#define R5_REG_POSTION          16
+#define R4_REG_POSTION          17
 
 #define WEAK __attribute__((weak))
 #define NAKED __attribute__ ((naked))
 
+/* MPU stack guard: the lowest OS_MPU_GUARD_SIZE bytes of every stack are mapped as no-access by one region */
+#define OS_MPU_GUARD_REGION     7U          // Highest priority region, wins over any region set by the application
+#define OS_MPU_GUARD_SIZE       32U         // Smallest MPU region, stacks must be aligned to it
+
+/* Zero-wait-state CCM RAM placement. The region is zeroed by the startup code and is not reachable by the DMA */
+#if OS_USE_CCMRAM
+#define OS_CCMRAM __attribute__((section(".ccmbss")))
+#else
+#define OS_CCMRAM
+#endif
+
+/**
+ * @brief Define a task stack of size bytes, sized at compile time and aligned as the AAPCS requires.
+ * Example: OS_TASK_STACK_DEFINE(ledStack, 128); osTaskCreate(&ledCtrl, OS_LOW_PRIORITY, ledTask, &led, OS_TASK_STACK(ledStack));
+ */
+#define OS_STACK_WORDS(size)                (((size) + 7U) / 8U * 2U)
+#if OS_USE_MPU_STACK_GUARD
+#define OS_TASK_STACK_DEFINE(name, size)    u32 name[OS_STACK_WORDS(size) + OS_MPU_GUARD_SIZE / 4U] __attribute__((aligned(OS_MPU_GUARD_SIZE)))
+#else
+#define OS_TASK_STACK_DEFINE(name, size)    u32 name[OS_STACK_WORDS(size)] __attribute__((aligned(8)))
+#endif
+#define OS_TASK_STACK(name)                 (name), sizeof(name)
+
 #define ENTER_CRITICAL_SECTION if ( osGetStatus() == OS_STATUS_RUNNING) osEnterCriticalSection();
 #define EXIT_CRITICAL_SECTION  if ( osGetStatus() == OS_STATUS_RUNNING) osExitCriticalSection();
 
 /* Exported types ------------------------------------------------------------*/
 
+typedef uint64_t    u64;
 typedef uint32_t    u32;
 typedef uint16_t    u16;
 typedef uint8_t     u8;
@@ -90,12 +116,23 @@ typedef int8_t      i8;
  * @brief Status of the Operating System Enum 
  */
 typedef enum{
-    OS_STATUS_RUNNING   = 0,
-    OS_STATUS_RESET     = 1,
+    OS_STATUS_RESET     = 0,                    // Power-on status (zero initialized) until osStart
+    OS_STATUS_RUNNING   = 1,
     OS_STATUS_STOPPED   = 2,
 	OS_STATUS_IRQ		= 3,
 }osStatus;
 
+/**
+ * @brief Errors reported in osLastError before calling osErrorHook.
+ */
+typedef enum{
+    OS_ERROR_NONE           = 0,
+    OS_ERROR_STACK_OVERFLOW = 1,
+    OS_ERROR_DEADLINE_MISS  = 2,            // A job of a periodic task finished after its deadline (osDeadlineMissHook)
+    OS_ERROR_NOT_SCHEDULABLE = 3,           // osTaskCreatePeriodic rejected a task that would make the set miss deadlines
+    OS_ERROR_SCHED_CONFIG   = 4,            // osStart found a wrong scheduler configuration (a minor frame of 0 ticks)
+}osErrorType;
+
 /**
  * @brief Task execution status enum.
  * 
@@ -105,42 +142,138 @@ typedef enum{
     OS_TASK_READY       = 1,
     OS_TASK_BLOCKED     = 2,
     OS_TASK_SUSPENDED   = 3,
+    OS_TASK_DELETED     = 4,                // Returned from its function, the control block and the stack can be reused
 }osTaskStatusType;
 
 /**
  * @brief Priority level enum.
- *
+ * Any value from 0 (highest) to OS_MAX_PRIORITY - 1 (lowest) is a valid priority, the named
+ * levels are spread over that range (0, 1, 2 and 3 with the default 4 levels).
  */
 typedef enum
 {
-    OS_VERYHIGH_PRIORITY,
-    OS_HIGH_PRIORITY,
-    OS_NORMAL_PRIORITY,
-    OS_LOW_PRIORITY
+    OS_VERYHIGH_PRIORITY    = 0,
+    OS_HIGH_PRIORITY        = (OS_MAX_PRIORITY - 1U) / 3U,
+    OS_NORMAL_PRIORITY      = 2U * (OS_MAX_PRIORITY - 1U) / 3U,
+    OS_LOW_PRIORITY         = OS_MAX_PRIORITY - 1U
 }osPriorityType;
 
 /**
- * @brief Structure used to control the Task.
- * 
+ * @brief What a blocked task is waiting for, see taskBlockedOn.
+ */
+typedef enum{
+    OS_BLOCKED_NONE         = 0,            // Delay, or blocked forever
+    OS_BLOCKED_QUEUE_FULL   = 1,            // osQueueSend on a full queue
+    OS_BLOCKED_QUEUE_EMPTY  = 2,            // osQueueReceive on an empty queue
+    OS_BLOCKED_SEMAPHORE    = 3,            // osSemaphoreTake on a taken semaphore
+    OS_BLOCKED_POOL         = 4,            // osPoolAlloc on an empty pool
+    OS_BLOCKED_PERIOD       = 5,            // Periodic task waiting for the release of its next job
+}osBlockedOnType;
+
+/**
+ * @brief What the kernel does with a task that used all its budget, until the budget is replenished.
+ */
+typedef enum{
+    OS_BUDGET_DEMOTE        = 0,            // Runs with OS_LOW_PRIORITY (suspended if it is scheduled by deadline)
+    OS_BUDGET_SUSPEND       = 1,            // Doesn't run
+    OS_BUDGET_HOOK          = 2,            // Only osBudgetOverrunHook is called, the task keeps running
+}osBudgetActionType;
+
+/**
+ * @brief How the budget is replenished.
+ */
+typedef enum{
+    OS_BUDGET_PERIODIC      = 0,            // Full budget at the start of every period (deferrable server)
+    OS_BUDGET_SPORADIC      = 1,            // Every chunk of execution is given back one period after it started (sporadic server)
+}osBudgetReplenishType;
+
+/**
+ * @brief Execution time budget of a task. Given to osTaskSetBudget, owned by the kernel while in use.
+ */
+typedef struct osBudgetObject{
+    osTimerObject timer;                    // Replenishment
+    u32 budget;                             // Ticks of execution per period
+    u32 period;                             // Replenishment period in ticks
+    u32 left;                               // Ticks left until the action is applied
+    u8  action;                             // osBudgetActionType
+    u8  replenish;                          // osBudgetReplenishType
+    bool exhausted;                         // The action was applied and the budget was not replenished yet
+    bool suspended;                         // The task is suspended by the budget (not by osTaskSuspend of the application)
+    bool demoted;                           // The task is demoted by the budget and its priority was not changed since
+    u8  savedPriority;                      // Priority before OS_BUDGET_DEMOTE
+    u32 overruns;                           // Times the budget was exhausted
+    /* Sporadic: chunk of execution in progress and replenishments pending, oldest first */
+    u32 chunkStart;
+    u32 chunkUsed;
+    u8  replCount;
+    u32 replTime[OS_BUDGET_MAX_REPLENISH];
+    u32 replAmount[OS_BUDGET_MAX_REPLENISH];
+}osBudgetObject;
+
+/**
+ * @brief Minor frame of the cyclic table of OS_WITH_TIME_PARTITION (see OS_PARTITION_TABLE).
  */
 typedef struct{
-    u32 taskMemory[OS_MAX_STACK_SIZE/4];    // Memory Size
+    u8  partition;                          // Partition that runs in the frame, OS_PARTITION_NONE for IDLE
+    u32 ticks;                              // Length of the frame, at least 1
+}osMinorFrame;
+
+/**
+ * @brief Structure used to control the Task.
+ * The fields read by the scheduler, SysTick and PendSV on every switch go first so they share
+ * the first 32 bytes. The stack is not part of it, it is given to osTaskCreate.
+ */
+typedef struct osTaskObject{
+    /* Hot: scheduler and context switch */
     u32 taskStackPointer;                   // Store the task SP
-    void* taskEntryPoint;                   // Entry point for the task
-    osTaskStatusType taskExecStatus;        // Task current execution status
-    osPriorityType taskPriority;       // Task priority (Not in used for now)
-    u32 taskID;                             // Task ID
-    char* taskName[OS_MAX_TASK_NAME_CHAR];  // Task name in string
-    u32 delay;
-    bool  queueBlockedFromFull;
-    bool  queueBlockedFromEmpty;
-    bool  semBlocked;
-    osQueueObject *queueFull;
-    osQueueObject *queueEmpty;
-    osSemaphoreObject *sem;
+    struct osTaskObject* readyNext;         // Ready list of taskRunPriority (NULL when the task is not ready)
+    struct osTaskObject* readyPrev;
+    u32 taskSliceLeft;                      // Ticks left of the current quantum
+    u8  taskExecStatus;                     // Task current execution status (osTaskStatusType)
+    u8  taskPriority;                       // Task priority (osPriorityType)
+    u8  taskRunPriority;                    // Priority used by the scheduler: the threshold once dispatched, until it blocks
+    u8  taskPreemptThreshold;               // While running only tasks above this priority preempt it
+    bool taskUsesFpu;                       // The task has FPU context, its switches save s16-s31 (updated on every switch)
+    u8  taskBlockedOn;                      // Object the task is blocked on (osBlockedOnType)
+    u8  taskID;                             // Task ID, 0 is IDLE
+    u8  taskPartition;                      // Partition of the task with OS_WITH_TIME_PARTITION, 0 otherwise
+    u32 taskTimeSlice;                      // Round-robin quantum in ticks, 0 uses the one of the priority level
+    osBudgetObject* taskBudget;             // Execution time budget charged on every tick, NULL without budget
+#if OS_USE_MPU_STACK_GUARD
+    u32 taskStackGuard;                     // MPU RBAR value of the guard below the stack, written on every switch
+#endif
+    /* Cold: blocking, creation, timeouts and debug */
+    union{
+        void* object;
+        osQueueObject* queue;
+        osSemaphoreObject* sem;
+        osPoolObject* pool;
+    }taskBlockedObject;                     // Valid while taskBlockedOn is not OS_BLOCKED_NONE
+    osTimerObject timeout;                  // Timer used by osDelay and the blocking APIs with timeout
+    u32* taskStack;                         // Lowest usable address of the stack
+    u32 taskStackSize;                      // Stack size in bytes
+    void* taskEntryPoint;                   // Entry point for the task, the job function of a periodic task
+    void* taskArg;                          // Argument of the job function of a periodic task
+    u32 taskPeriod;                         // Release period of a periodic task in ticks, 0 for the other tasks
+    u32 taskDeadline;                       // Deadline of every job, relative to its release
+    u32 taskRelease;                        // Absolute tick of the release of the current job
+    u32 taskAbsDeadline;                    // Absolute tick of the deadline of the current job
+    u32 taskDeadlineMisses;                 // Jobs finished on the tick of their deadline or later
+    u32 taskWcet;                           // Declared worst case execution time of a job in ticks, for the admission control
+    u8  taskListIndex;                      // Position in the list of tasks of the kernel, for its O(1) removal
+    char taskName[OS_MAX_TASK_NAME_CHAR];   // Task name, NUL terminated (see osTaskSetName)
 }osTaskObject;
 
 
+/**
+ * @brief Kernel statistics, see osGetStats.
+ */
+typedef struct{
+    u32 ticks;                              // Ticks since osStart
+    u32 switches;                           // Context switches done
+    u32 switchesAvoided;                    // Decisions of the tick or after a wakeup that kept the running task, PendSV was not triggered
+}osKernelStats;
+
 /* Exported constants --------------------------------------------------------*/
 
 
@@ -149,13 +282,88 @@ typedef struct{
 /**
  * @brief osTaskCreate helps to create a new task for the OS
  * @param osTaskObject* taskCtrlStruct
- * @param void* taskFunction
  * @param OsTaskPriorityLevel priority
+ * @param void* taskFunction -> void task(void* arg)
+ * @param void* arg -> passed to taskFunction in R0, one function can serve several tasks
+ * @param u32* stack -> memory of the stack, 8 bytes aligned (see OS_TASK_STACK_DEFINE)
+ * @param u32 stackSize -> size of the stack in bytes, multiple of 8 and at least OS_MIN_STACK_SIZE
+ * Tasks that use the FPU need OS_FPU_CONTEXT_SIZE more bytes of stack.
+ * With OS_USE_MPU_STACK_GUARD the stack must be aligned to OS_MPU_GUARD_SIZE and its first
+ * OS_MPU_GUARD_SIZE bytes are used as guard.
+ * A task can return from its function: it is deleted and its control block and stack can be
+ * given again to osTaskCreate.
+ */
+bool osTaskCreate(osTaskObject* taskCtrlStruct, osPriorityType priority, void* taskFunction, void* arg, u32* stack, u32 stackSize);
+
+/**
+ * @brief Create a periodic task. The kernel calls jobFunction(arg) once per period: the jobs are
+ * released at exact multiples of period from the tick of the creation (tick 0 before osStart), so
+ * they don't drift nor accumulate jitter. A job that finishes on the tick of its deadline or later
+ * is counted (osTaskGetDeadlineMisses) and reported to osDeadlineMissHook. The next job of a late
+ * one is released at once, no job is lost.
+ * With OS_USE_RATE_MONOTONIC the priorities of all the periodic tasks are assigned again from
+ * their periods on every creation, between OS_RM_HIGHEST_PRIORITY and OS_RM_LOWEST_PRIORITY.
+ * Otherwise the task is created with OS_NORMAL_PRIORITY, see osTaskSetPriority.
+ * With OS_WITH_EDF the jobs are scheduled by their absolute deadline and the priority is not used.
+ * @param osTaskObject* taskCtrlStruct
+ * @param u32 period -> ticks between releases
+ * @param u32 deadline -> ticks from the release, between 1 and period. 0 is the period
+ * @param u32 wcet -> worst case execution time of a job in ticks, between 1 and the deadline.
+ * With OS_USE_ADMISSION_CONTROL the task is only created if the periodic tasks keep meeting their
+ * deadlines with it (response time analysis, or density up to 1 with EDF). Otherwise returns false
+ * and osGetLastError gives OS_ERROR_NOT_SCHEDULABLE.
+ * @param void* jobFunction -> void job(void* arg), must return at the end of every job
+ * @param void* arg
+ * @param u32* stack, u32 stackSize -> as in osTaskCreate
+ */
+bool osTaskCreatePeriodic(osTaskObject* taskCtrlStruct, u32 period, u32 deadline, u32 wcet, void* jobFunction, void* arg, u32* stack, u32 stackSize);
+
+/**
+ * @brief Give a deadline to the current job of a task that is not periodic (a sporadic job), relative
+ * to now. With OS_WITH_EDF the task is scheduled by its deadline until it is cleared, with the other
+ * schedulers it is only recorded in taskAbsDeadline.
+ * @param osTaskObject* task -> NULL is the calling task (false before osStart)
+ * @param u32 deadline -> ticks from now, 0 clears it and the task goes back to its priority
+ * @return bool -> false for IDLE and periodic tasks, their deadlines come from their releases
+ */
+bool osTaskSetDeadline(osTaskObject* task, const u32 deadline);
+
+/**
+ * @brief Limit the CPU time of a task to ticks every period. Every tick the running task is charged
+ * one tick, when its budget is used the action is applied until the budget is replenished. The
+ * replenishment only undoes the action: an osTaskSuspend or osTaskSetPriority of the application
+ * while the budget was exhausted is kept.
+ * A task of high priority that handles aperiodic events with OS_BUDGET_SUSPEND is a deferrable
+ * (OS_BUDGET_PERIODIC) or a sporadic (OS_BUDGET_SPORADIC) server: the events get a fast response and
+ * the tasks below it lose at most ticks every period (see osWorkQueueSetServer).
+ * @param osTaskObject* task
+ * @param osBudgetObject* budget -> memory of the budget, NULL removes the budget of the task
+ * @param u32 ticks -> between 1 and period
+ * @param u32 period -> replenishment period in ticks
+ * @param osBudgetActionType action
+ * @param osBudgetReplenishType replenish
+ */
+bool osTaskSetBudget(osTaskObject* task, osBudgetObject* budget, u32 ticks, u32 period, osBudgetActionType action, osBudgetReplenishType replenish);
+
+#ifdef OS_WITH_TIME_PARTITION
+/**
+ * @brief Move a task to a partition. Its tasks only run in the minor frames of the partition, and
+ * inside them they are scheduled by priority. Tasks are created in partition 0.
+ * @param osTaskObject* task
+ * @param u8 partition -> 0 to OS_PARTITIONS - 1
+ */
+bool osTaskSetPartition(osTaskObject* task, const u8 partition);
+#endif
+
+/**
+ * @brief Jobs of a periodic task that missed their deadline.
  */
-bool osTaskCreate(osTaskObject* taskCtrlStruct, osPriorityType priority, void* taskFunction);
+u32 osTaskGetDeadlineMisses(const osTaskObject* task);
 
 /**
  * @brief This function needs to be invoqued after creating all the tasks 
+ * Launches the highest priority task through SVC and never returns. The stack of main is
+ * reused by the IRQs, so nothing allocated on it can be used by the tasks.
  */
 void osStart(void);
 
@@ -165,12 +373,107 @@ void osStart(void);
 
 void osDelay(const u32 tick);
 
+/**
+ * @brief Get the number of ticks since osStart.
+ */
+u32 osGetTick(void);
+
+/**
+ * @brief Maximum stack used by the task since it was created.
+ * The stack is painted with OS_STACK_FILL_PATTERN in osTaskCreate, the words that still have
+ * the pattern were never used.
+ * @param osTaskObject* task
+ * @return u32 -> bytes used, compare it with taskStackSize to trim the stack.
+ */
+u32 osTaskGetStackHighWater(const osTaskObject* task);
+
+/**
+ * @brief Set the name of a task, shown by the debugger. Longer names are truncated to
+ * OS_MAX_TASK_NAME_CHAR - 1 characters.
+ * @param osTaskObject* task
+ * @param const char* name
+ */
+void osTaskSetName(osTaskObject* task, const char* name);
+
+/**
+ * @brief Set the round-robin quantum of a task. The task keeps the CPU for this amount of ticks
+ * while other tasks of its priority are ready, unless it blocks or a higher priority task preempts it.
+ * @param osTaskObject* task
+ * @param u32 ticks -> quantum in ticks, 0 uses the one of the priority level (OS_TIME_SLICE_*)
+ */
+bool osTaskSetTimeSlice(osTaskObject* task, const u32 ticks);
+
+/**
+ * @brief Set the preemption threshold of a task. While the task runs only tasks with a priority
+ * higher than the threshold can preempt it, and it is not rotated with the tasks of its level.
+ * Tasks that never preempt each other can't be on the stack at the same time, which saves
+ * context switches and stack.
+ * @param osTaskObject* task
+ * @param osPriorityType threshold -> between the priority of the task (no threshold) and OS_VERYHIGH_PRIORITY
+ * @return bool -> false if the threshold is lower than the priority of the task
+ */
+bool osTaskSetPreemptionThreshold(osTaskObject* task, const osPriorityType threshold);
+
+/**
+ * @brief Suspend a task until osTaskResume. A blocked task stops waiting (its timeout too), the
+ * blocking API checks again once the task is resumed.
+ * @param osTaskObject* task -> NULL suspends the calling task (false before osStart)
+ * @return bool -> false for IDLE or a task that is already suspended or deleted
+ */
+bool osTaskSuspend(osTaskObject* task);
+
+/**
+ * @brief Make a suspended task ready again. Can be called from IRQs.
+ * @param osTaskObject* task
+ * @return bool -> false if the task was not suspended
+ */
+bool osTaskResume(osTaskObject* task);
+
+/**
+ * @brief Delete a task, as if it returned from its function but without osReturnTaskHook.
+ * Its control block and stack can be given to osTaskCreate again. A task that deletes itself inside a
+ * critical section ends it: the IRQs are enabled so the switch can happen.
+ * @param osTaskObject* task -> NULL deletes the calling task, then the call never returns (false before osStart)
+ * @return bool -> false for IDLE or a task already deleted
+ */
+bool osTaskDelete(osTaskObject* task);
+
+/**
+ * @brief Change the priority of a task. A ready task moves to the tail of its new level, the
+ * running one stays at the head. A preemption threshold lower than the new priority is raised to it.
+ * @param osTaskObject* task
+ * @param osPriorityType priority
+ * @return bool -> false for IDLE, a deleted task or an invalid priority
+ */
+bool osTaskSetPriority(osTaskObject* task, const osPriorityType priority);
+
+/**
+ * @brief Read the kernel statistics.
+ * @param osKernelStats* stats
+ */
+void osGetStats(osKernelStats* stats);
+
+/**
+ * @brief Last error detected by the OS (osErrorType).
+ */
+osErrorType osGetLastError(void);
+
+/**
+ * @brief Must be called from MemManage_Handler. If the fault was an access to the stack guard of
+ * the running task sets OS_ERROR_STACK_OVERFLOW and calls osErrorHook with the task.
+ * @return bool -> true if the fault was a stack overflow.
+ */
+bool osStackGuardFault(void);
+
 /**
  * @brief Weak functions that can be used by the User if necesary 
+ * osReturnTaskHook is called by a task that returns from its function, before it is deleted.
  */
 WEAK void osSysTickHook(void);
-WEAK void osReturnTaskHook(void);
+WEAK void osReturnTaskHook(osTaskObject* task);
 WEAK void osErrorHook(void* caller);
+WEAK void osDeadlineMissHook(osTaskObject* task);
+WEAK void osBudgetOverrunHook(osTaskObject* task);
 WEAK void osIdleTask(void);
 
 
@@ -186,8 +489,9 @@ void osExitCriticalSection(void);
 
 /**
  * @brief This function is used when there is no available place on the queue to send something.
+ * If timeout is not MAX_DELAY the task is unblocked after timeout ticks.
  */
-void blockTaskFromQueue(osQueueObject *queue, u8 sender);
+void blockTaskFromQueue(osQueueObject *queue, u8 sender, u32 timeout);
 
 /**
  * @brief This function is used to unblock the task that is blocked because there wasn't place for sending.
@@ -204,6 +508,17 @@ void blockTaskFromSem(osSemaphoreObject* sem);
  */
 void checkBlockedTaskFromSem(osSemaphoreObject *sem);
 
+/**
+ * @brief This function is used when the pool has no free block to block the current task.
+ * If timeout is not MAX_DELAY the task is unblocked after timeout ticks.
+ */
+void blockTaskFromPool(osPoolObject *pool, u32 timeout);
+
+/**
+ * @brief This function is used when a block is given back to an empty pool.
+ */
+void checkBlockedTaskFromPool(osPoolObject *pool);
+
 
 void osSetStatus(osStatus s);
 
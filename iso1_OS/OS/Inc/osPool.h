@@ -0,0 +1,101 @@
+#ifndef INC_OSPOOL_H
+#define INC_OSPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Fixed-block memory pool.
+ * The storage is a static array of blockCount blocks of blockSize bytes. Every free block keeps
+ * the address of the next free block in its first word, so alloc and free are a pop and a push
+ * on that list: constant time and callable from IRQs.
+ *
+ *  freeList -> | next | ... | -> | next | ... | -> | NULL | ... |
+ */
+
+/* Block size rounded up to a word so every block is aligned */
+#define OS_POOL_BLOCK_SIZE(size)    ((((uint32_t)(size)) + 3U) & ~3U)
+
+/**
+ * @brief Define the storage of a pool with the right size and alignment.
+ * Example: OS_POOL_BUFFER(msgBuffer, sizeof(msg_t), 16); osPoolInit(&msgPool, msgBuffer, sizeof(msg_t), 16);
+ */
+#define OS_POOL_BUFFER(name, blockSize, blockCount) \
+    uint32_t name[(OS_POOL_BLOCK_SIZE(blockSize) / 4U) * (blockCount)]
+
+/**
+ * @brief Data structure pool.
+ */
+typedef struct
+{
+    uint8_t*    buffer;         // Storage of the blocks
+    void*       freeList;       // First free block
+    uint32_t    blockSize;      // Size of each block in bytes (word aligned)
+    uint32_t    blockCount;     // Number of blocks
+    uint32_t    used;           // Blocks allocated now
+    uint32_t    highWater;      // Maximum blocks allocated at the same time
+    uint32_t    failures;       // Allocations that returned NULL
+}osPoolObject;
+
+/**
+ * @brief Pool usage statistics.
+ */
+typedef struct
+{
+    uint32_t    blockSize;
+    uint32_t    blockCount;
+    uint32_t    used;
+    uint32_t    highWater;
+    uint32_t    failures;
+}osPoolStats;
+
+/**
+ * @brief Initialize the pool.
+ *
+ * @param[in, out]  pool        Pool object.
+ * @param[in]       buffer      Storage, at least blockCount * OS_POOL_BLOCK_SIZE(blockSize) bytes, word aligned.
+ * @param[in]       blockSize   Size of each block in bytes.
+ * @param[in]       blockCount  Number of blocks.
+ *
+ * @return Returns true if was success in otherwise false.
+ */
+bool osPoolInit(osPoolObject* pool, void* buffer, const uint32_t blockSize, const uint32_t blockCount);
+
+/**
+ * @brief Take a block from the pool.
+ *
+ * @param[in, out]  pool    Pool object.
+ * @param[in]       timeout Maximum ticks to stay blocked if the pool is empty. 0 does not block (must be 0 from IRQs),
+ *                          MAX_DELAY waits forever.
+ *
+ * @return Returns the block or NULL if there was no free block.
+ */
+void* osPoolAlloc(osPoolObject* pool, const uint32_t timeout);
+
+/**
+ * @brief Give back a block to the pool. Can be called from IRQs.
+ *
+ * @param[in, out]  pool    Pool object.
+ * @param[in]       block   Block returned by osPoolAlloc.
+ *
+ * @return Returns false if the block does not belong to the pool, or with OS_USE_POOL_CHECK if it is already free.
+ */
+bool osPoolFree(osPoolObject* pool, void* block);
+
+/**
+ * @brief Read the usage statistics of the pool.
+ *
+ * @param[in]   pool    Pool object.
+ * @param[out]  stats   Statistics.
+ */
+void osPoolGetStats(const osPoolObject* pool, osPoolStats* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_OSPOOL_H
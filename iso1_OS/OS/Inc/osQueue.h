@@ -37,7 +37,7 @@ bool osQueueInit(osQueueObject* queue, const uint32_t dataSize);
  *
  * @param[in, out]  queue   Queue object.
  * @param[in, out]  data    Data sent to the queue.
- * @param[in]       timeout Number of ticks to wait before blocking the task..
+ * @param[in]       timeout Maximum ticks to stay blocked. 0 does not block, MAX_DELAY waits forever.
  *
  * @return Returns true if it could be put in the queue
  * in otherwise false.
@@ -49,7 +49,7 @@ bool osQueueSend(osQueueObject* queue, const void* data, const uint32_t timeout)
  *
  * @param[in, out]  queue   Queue object.
  * @param[in, out]  buffer  Buffer to  save the data read from the queue.
- * @param[in]       timeout Number of ticks to wait before blocking the task..
+ * @param[in]       timeout Maximum ticks to stay blocked. 0 does not block, MAX_DELAY waits forever.
  *
  * @return Returns true if it was possible to take it out in the queue
  * in otherwise false.
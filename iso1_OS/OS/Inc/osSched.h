@@ -0,0 +1,123 @@
+#ifndef INC_OSSCHED_H
+#define INC_OSSCHED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "osKernel.h"
+
+/*
+ * Scheduler policy interface.
+ *
+ * The kernel keeps the tasks, their status, slices, timers and the context switch, and asks the
+ * policy selected in osConfig.h which task must run. Every policy is a source file that is only
+ * compiled with its define, so exactly one implementation of these functions is linked and the
+ * kernel calls it directly, without function pointers:
+ *
+ *  OS_SIMPLE               osSchedRR.c     round-robin of the ready tasks
+ *  OS_WITH_PRIORITY        osSchedFP.c     fixed priority, round-robin inside each level
+ *  OS_WITH_EDF             osSchedEDF.c    earliest deadline first, fixed priority for the tasks without deadline
+ *  OS_WITH_TIME_PARTITION  osSchedTP.c     cyclic table of partitions, fixed priority inside them
+ *
+ * The operations a policy doesn't need are defined here as empty macros.
+ * A new policy adds its define to osConfig.h, its section below and its source file.
+ *
+ * Rules for the policies:
+ *  - They are called with the IRQs disabled (or from SysTick/PendSV) and must not block.
+ *  - The ready tasks are linked with readyNext/readyPrev, which must be NULL when the task is not
+ *    ready: the kernel uses readyNext to know if a task is in the ready structure.
+ *  - IDLE is never given to them, osSchedPickNext returns NULL when nothing is ready.
+ */
+
+extern osTaskObject idle;                       // Task of the kernel, never in the ready structures
+
+/**
+ * @brief On-ready: the task enters the ready structure.
+ * @param osTaskObject* task
+ * @param bool head -> the task is running and keeps the CPU (it was only moved)
+ */
+void osSchedOnReady(osTaskObject* task, bool head);
+
+/**
+ * @brief On-block: the task leaves the ready structure (blocked, suspended, deleted or moved).
+ */
+void osSchedOnBlock(osTaskObject* task);
+
+/**
+ * @brief Pick-next: task that must run now. Executed by every scheduler run.
+ * @param osTaskObject* curr -> running task, its taskSliceLeft is 0 when its quantum is over
+ * @return osTaskObject* -> NULL to run IDLE
+ */
+osTaskObject* osSchedPickNext(const osTaskObject* curr);
+
+/* Policy dependent operations -----------------------------------------------*/
+
+#if defined(OS_WITH_PRIORITY) || defined(OS_WITH_EDF) || defined(OS_WITH_TIME_PARTITION)
+/**
+ * @brief On-dispatch: the task gets the CPU (preemption threshold).
+ */
+void osSchedOnDispatch(osTaskObject* task);
+#else
+#define osSchedOnDispatch(task)     ((void)(task))
+#endif
+
+#ifdef OS_WITH_TIME_PARTITION
+/**
+ * @brief Executed by osStart before the first pick.
+ * @return bool -> false if the configuration of the policy is not valid, the kernel is not started
+ */
+bool osSchedInit(void);
+
+/**
+ * @brief On-tick: executed by SysTick before the scheduler runs.
+ */
+void osSchedOnTick(void);
+#else
+#define osSchedInit()               (true)
+#define osSchedOnTick()             ((void)0)
+#endif
+
+/* The ready structure depends on the absolute deadline of the tasks, changing it moves the task */
+#ifdef OS_WITH_EDF
+#define OS_SCHED_USES_DEADLINE      1
+#else
+#define OS_SCHED_USES_DEADLINE      0
+#endif
+
+/* Fixed priority ready lists, shared by the policies -------------------------*/
+
+/**
+ * @brief Circular list of the ready tasks of every priority, plus a bitmap of the non empty ones.
+ */
+typedef struct{
+    u32 bitmap;                                 // OS_READY_BIT(p) is set when the ready list of priority p is not empty
+    osTaskObject* list[OS_MAX_PRIORITY];        // The head runs first
+}osReadyQueue;
+
+/**
+ * @brief Add a task to the list of its run priority, at the tail or at the head.
+ */
+void osReadyQueueInsert(osReadyQueue* ready, osTaskObject* task, bool head);
+
+/**
+ * @brief Remove a task from the list of its run priority.
+ */
+void osReadyQueueRemove(osReadyQueue* ready, osTaskObject* task);
+
+/**
+ * @brief Head of the highest priority list. If it is curr and its quantum is over the list is rotated.
+ * @return osTaskObject* -> NULL if all the lists are empty
+ */
+osTaskObject* osReadyQueueBest(osReadyQueue* ready, const osTaskObject* curr);
+
+/**
+ * @brief While running the task competes with its preemption threshold, at the head of that list.
+ */
+void osReadyQueueDispatch(osReadyQueue* ready, osTaskObject* task);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_OSSCHED_H
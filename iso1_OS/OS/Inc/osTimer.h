@@ -0,0 +1,108 @@
+#ifndef INC_OSTIMER_H
+#define INC_OSTIMER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Hierarchical timing wheel.
+ *
+ * Level 0 has one slot per tick, every upper level has one slot per full turn of the level below.
+ * With 4 levels of 64 slots a timer up to 2^24 ticks away is placed directly, longer timeouts are
+ * parked in the last slot of the top level and re-evaluated when that slot is cascaded.
+ *
+ *  level 3  |   |   |   | ... |   |   each slot = 2^18 ticks
+ *  level 2  |   |   |   | ... |   |   each slot = 2^12 ticks
+ *  level 1  |   |   |   | ... |   |   each slot = 2^6  ticks
+ *  level 0  |   |   |   | ... |   |   each slot = 1    tick
+ *
+ * Arm and cancel are O(1) (list insert/unlink), expiry is amortised O(1) per tick.
+ */
+#define OS_TIMER_WHEEL_BITS     6U
+#define OS_TIMER_WHEEL_SLOTS    (1U << OS_TIMER_WHEEL_BITS)     // Slots per level
+#define OS_TIMER_WHEEL_MASK     (OS_TIMER_WHEEL_SLOTS - 1U)
+#define OS_TIMER_WHEEL_LEVELS   4U                              // Levels of the wheel
+
+/**
+ * @brief Function executed when the timer expires. Runs in SysTick context.
+ */
+typedef void (*osTimerCallback)(void* arg);
+
+/**
+ * @brief Timer object. Must be initialized with osTimerInit before being used.
+ */
+typedef struct osTimerObject
+{
+    struct osTimerObject*   next;       // Next timer in the same slot
+    struct osTimerObject**  pprev;      // Pointer to the previous "next" field (NULL when not armed)
+    uint32_t                expiry;     // Absolute tick of expiration
+    uint32_t                period;     // Reload value in ticks, 0 for one-shot timers
+    osTimerCallback         callback;   // Function executed on expiration
+    void*                   arg;        // Argument passed to the callback
+}osTimerObject;
+
+/**
+ * @brief Initialize a timer.
+ *
+ * @param[in, out]  timer       Timer object.
+ * @param[in]       callback    Function executed when the timer expires.
+ * @param[in]       arg         Argument passed to the callback. Could be NULL.
+ */
+void osTimerInit(osTimerObject* timer, osTimerCallback callback, void* arg);
+
+/**
+ * @brief Arm a timer. If it was already armed it is re-armed with the new values.
+ *
+ * @param[in, out]  timer   Timer object.
+ * @param[in]       ticks   Ticks until the first expiration (0 is treated as 1).
+ * @param[in]       period  Reload value in ticks for periodic timers, 0 for one-shot.
+ *
+ * @return Returns true if the timer was armed in otherwise false.
+ */
+bool osTimerStart(osTimerObject* timer, const uint32_t ticks, const uint32_t period);
+
+/**
+ * @brief Arm a timer at an absolute tick. Used to release periodic work without drift.
+ *
+ * @param[in, out]  timer   Timer object.
+ * @param[in]       expiry  Absolute tick of expiration. Must be in the future.
+ * @param[in]       period  Reload value in ticks for periodic timers, 0 for one-shot.
+ *
+ * @return Returns true if the timer was armed in otherwise false.
+ */
+bool osTimerStartAt(osTimerObject* timer, const uint32_t expiry, const uint32_t period);
+
+/**
+ * @brief Cancel a timer. Safe to call if the timer is not armed.
+ *
+ * @param[in, out]  timer   Timer object.
+ *
+ * @return Returns true if the timer was armed.
+ */
+bool osTimerStop(osTimerObject* timer);
+
+/**
+ * @brief Check if the timer is armed.
+ */
+bool osTimerIsActive(const osTimerObject* timer);
+
+/**
+ * @brief Current tick of the wheel, the time base of the OS (osGetTick). Counts from osStart.
+ */
+uint32_t osTimerNow(void);
+
+/**
+ * @brief Advance the wheel by one tick and execute the expired timers.
+ * @note Used internally by the OS from SysTick_Handler.
+ */
+void osTimerTick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_OSTIMER_H
@@ -0,0 +1,77 @@
+#ifndef INC_OSWORKQUEUE_H
+#define INC_OSWORKQUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "osKernel.h"
+
+/*
+ * Deferred work (bottom half).
+ * An IRQ handler submits a work object and returns, the work function is executed later by the
+ * worker task at the priority given to osWorkQueueInit. A work object that is submitted again while
+ * it is still pending is executed only once (the submissions are coalesced).
+ */
+
+typedef void (*osWorkFunction)(void* arg);
+
+/**
+ * @brief Work object. Must be initialized with osWorkInit before being submitted.
+ */
+typedef struct osWorkObject
+{
+    struct osWorkObject*    next;       // Next pending work
+    osWorkFunction          function;   // Function executed by the worker task
+    void*                   arg;        // Argument passed to the function
+    volatile bool           pending;    // Submitted and not executed yet
+    uint32_t                coalesced;  // Submissions merged with a pending one
+}osWorkObject;
+
+/**
+ * @brief Create the worker task. Must be called before osStart.
+ *
+ * @param[in]   priority    Priority of the worker task.
+ *
+ * @return Returns true if the worker task was created in otherwise false.
+ */
+bool osWorkQueueInit(osPriorityType priority);
+
+/**
+ * @brief Turn the worker task into a server of the aperiodic work: it runs at its priority for at most
+ * budget ticks every period, then it is suspended until the budget is replenished. The work of IRQ
+ * bursts gets a fast response and the tasks below the worker keep the rest of the CPU.
+ *
+ * @param[in]   budget      Ticks of work per period, 1 to period.
+ * @param[in]   period      Replenishment period in ticks.
+ * @param[in]   replenish   OS_BUDGET_PERIODIC (deferrable server) or OS_BUDGET_SPORADIC (sporadic server).
+ *
+ * @return Returns true if the budget was set in otherwise false.
+ */
+bool osWorkQueueSetServer(uint32_t budget, uint32_t period, osBudgetReplenishType replenish);
+
+/**
+ * @brief Initialize a work object.
+ *
+ * @param[in, out]  work        Work object.
+ * @param[in]       function    Function executed by the worker task.
+ * @param[in]       arg         Argument passed to the function. Could be NULL.
+ */
+void osWorkInit(osWorkObject* work, osWorkFunction function, void* arg);
+
+/**
+ * @brief Queue the work to be executed by the worker task. Can be called from IRQs.
+ *
+ * @param[in, out]  work    Work object.
+ *
+ * @return Returns true if the work was queued, false if it was already pending (coalesced) or invalid.
+ */
+bool osWorkSubmit(osWorkObject* work);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // INC_OSWORKQUEUE_H
@@ -0,0 +1,159 @@
+#include "osBenchmark.h"
+#include "osTimer.h"
+
+#if OS_USE_BENCHMARK
+
+osBenchCounter osBenchSysTick;
+osBenchCounter osBenchPendSV;
+osBenchCounter osBenchPendSVFpu;
+osBenchCounter osBenchPendSVInt;
+u32 osBenchStartup;
+static u32 benchPendSVStart;
+static bool benchPendSVFpu;
+
+static osTimerObject benchTimers[OS_BENCH_TIMER_POOL];
+static u32 benchExpired;
+static u32 benchSeed = 1;
+
+/* Private functions declarations */
+static u32 benchRandom(void);
+static void benchTimerCallback(void* arg);
+static void benchSampleTicks(osBenchCounter* counter);
+
+
+void osBenchInit(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void osBenchCounterReset(osBenchCounter* counter)
+{
+    counter->last = 0;
+    counter->min = 0xFFFFFFFF;
+    counter->max = 0;
+    counter->samples = 0;
+    counter->total = 0;
+}
+
+void osBenchCounterAdd(osBenchCounter* counter, const u32 cycles)
+{
+    counter->last = cycles;
+    if (cycles < counter->min) counter->min = cycles;
+    if (cycles > counter->max) counter->max = cycles;
+    counter->samples++;
+    counter->total += cycles;
+}
+
+u32 osBenchCounterAverage(const osBenchCounter* counter)
+{
+    if (counter->samples == 0) return 0;
+    return (u32)(counter->total / counter->samples);
+}
+
+void osBenchPendSVStart(const u32 excReturn)
+{
+    benchPendSVStart = osBenchCycles();
+    benchPendSVFpu = ((excReturn & EXEC_RETURN_FPU_MSK) == 0);
+}
+
+void osBenchPendSVEnd(const u32 excReturn)
+{
+    u32 cycles = osBenchCycles() - benchPendSVStart;
+
+    osBenchCounterAdd(&osBenchPendSV, cycles);
+    if (benchPendSVFpu || (excReturn & EXEC_RETURN_FPU_MSK) == 0)
+    {
+        osBenchCounterAdd(&osBenchPendSVFpu, cycles);
+    }
+    else
+    {
+        osBenchCounterAdd(&osBenchPendSVInt, cycles);
+    }
+}
+
+void osBenchPendSVReset(void)
+{
+    osBenchCounterReset(&osBenchPendSV);
+    osBenchCounterReset(&osBenchPendSVFpu);
+    osBenchCounterReset(&osBenchPendSVInt);
+}
+
+void osBenchTimerWheel(osBenchTimerResult* result)
+{
+    osTimerObject* timer;
+    u32 start;
+    u32 ticks;
+
+    osBenchInit();
+    osBenchCounterReset(&result->arm);
+    osBenchCounterReset(&result->cancel);
+    benchExpired = 0;
+
+    for (u32 i = 0; i < OS_BENCH_TIMER_POOL; i++)
+    {
+        osTimerInit(&benchTimers[i], benchTimerCallback, NULL);
+    }
+
+    /* 1) Cost of the tick without timers */
+    benchSampleTicks(&result->tickIdle);
+
+    /* 2) Arm: spread the expirations over every level of the wheel, a few of them expire while sampling */
+    for (u32 i = 0; i < OS_BENCH_TIMERS; i++)
+    {
+        timer = &benchTimers[i % OS_BENCH_TIMER_POOL];
+        osTimerStop(timer);
+
+        ticks = benchRandom() >> (benchRandom() % 24);
+
+        start = osBenchCycles();
+        osTimerStart(timer, ticks, 0);
+        osBenchCounterAdd(&result->arm, osBenchCycles() - start);
+    }
+
+    /* 3) Cost of the tick with the pool armed */
+    result->armed = OS_BENCH_TIMER_POOL;
+    benchSampleTicks(&result->tickLoaded);
+
+    /* 4) Cancel: every measured cancel removes an armed timer */
+    for (u32 i = 0; i < OS_BENCH_TIMERS; i++)
+    {
+        timer = &benchTimers[i % OS_BENCH_TIMER_POOL];
+        if (!osTimerIsActive(timer)) osTimerStart(timer, 1 + (benchRandom() & 0xFFFFF), 0);
+
+        start = osBenchCycles();
+        osTimerStop(timer);
+        osBenchCounterAdd(&result->cancel, osBenchCycles() - start);
+    }
+
+    result->operations = OS_BENCH_TIMERS;
+    result->expired = benchExpired;
+}
+
+/**
+ * @brief Sample the cycles of SysTick_Handler for OS_BENCH_TICKS ticks.
+ */
+static void benchSampleTicks(osBenchCounter* counter)
+{
+    osDelay(1);     // Start aligned with the tick
+    osBenchCounterReset(&osBenchSysTick);
+    osDelay(OS_BENCH_TICKS);
+    *counter = osBenchSysTick;
+}
+
+static void benchTimerCallback(void* arg)
+{
+    benchExpired++;
+}
+
+/**
+ * @brief Linear congruential generator, good enough to spread the expirations.
+ */
+static u32 benchRandom(void)
+{
+    benchSeed = benchSeed * 1664525U + 1013904223U;
+    return benchSeed;
+}
+
+#endif // OS_USE_BENCHMARK
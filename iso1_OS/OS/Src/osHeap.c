@@ -0,0 +1,509 @@
+#include "osHeap.h"
+#include "osKernel.h"
+#include <string.h>
+
+#if OS_USE_HEAP
+
+/*
+ * Every block starts with a header. The free list pointers use the first bytes of the payload,
+ * so they only exist while the block is free.
+ *
+ *  | prevPhys | size + flags | payload (nextFree, prevFree when free) ... | next block header
+ *  ^-- block                 ^-- pointer returned to the user
+ *
+ * The last block of the region is a sentinel of size 0 marked as used, so the next block of any
+ * block always exists and the merge on free does not need to check the end of the region.
+ */
+#define HEAP_HEADER_SIZE    ((u32)offsetof(osHeapBlock, nextFree))      // prevPhys + size
+#define HEAP_MIN_PAYLOAD    ((u32)(2U * sizeof(osHeapBlock*)))          // nextFree + prevFree
+#define HEAP_FREE_FLAG      0x1U
+#define HEAP_SIZE_MASK      (~(OS_HEAP_ALIGN - 1U))
+#define HEAP_SMALL_SIZE     (1U << OS_HEAP_FL_SHIFT)
+#define HEAP_MAX_PAYLOAD    ((1U << OS_HEAP_FL_MAX) - OS_HEAP_ALIGN)
+
+typedef struct osHeapBlock
+{
+    struct osHeapBlock* prevPhys;                   // Block just before in memory (NULL for the first one)
+    u32                 size;                       // Payload size in bytes + flags
+    struct osHeapBlock* nextFree;                   // Only valid while the block is free
+    struct osHeapBlock* prevFree;                   // Only valid while the block is free
+}osHeapBlock;
+
+/**
+ * @brief Heap control structure.
+ * Is private to osHeap.c so is can't be manipulate from other files.
+ */
+typedef struct
+{
+    u32 flBitmap;                                           // Bit i set: some list of blocks[i] has blocks
+    u32 slBitmap[OS_HEAP_FL_COUNT];                         // Bit j set: blocks[i][j] has blocks
+    osHeapBlock* blocks[OS_HEAP_FL_COUNT][OS_HEAP_SL_COUNT];
+    u32 totalSize;
+    u32 usedSize;
+    u32 peakUsed;
+    u32 freeBlocks;
+    u32 allocations;
+    u32 failures;
+    bool initialized;
+}osHeapCtrl;
+
+static osHeapCtrl heap OS_CCMRAM;
+
+#if OS_HEAP_SIZE > 0
+/* Default region of the heap, only used if osHeapInit is not called before the first allocation */
+static u64 heapRegion[OS_HEAP_SIZE / sizeof(u64)];
+#endif
+
+/* Nesting of the heap lock, shared with the newlib __malloc_lock hooks */
+static u32 heapLockNesting;
+static u32 heapLockPrimask;
+
+/* Private functions declarations */
+static void heapLock(void);
+static void heapUnlock(void);
+static void heapMapping(u32 size, u32* fl, u32* sl);
+static osHeapBlock* heapFindSuitable(u32 size);
+static void heapInsert(osHeapBlock* block);
+static void heapRemove(osHeapBlock* block);
+static osHeapBlock* heapSplit(osHeapBlock* block, u32 size);
+static osHeapBlock* heapMergeNext(osHeapBlock* block);
+static u32 heapAdjustSize(u32 size);
+
+static inline u32 blockSize(const osHeapBlock* block)  { return block->size & HEAP_SIZE_MASK; }
+static inline bool blockIsFree(const osHeapBlock* block) { return (block->size & HEAP_FREE_FLAG) != 0; }
+static inline osHeapBlock* blockNext(const osHeapBlock* block)
+{
+    return (osHeapBlock*)((u8*)block + HEAP_HEADER_SIZE + blockSize(block));
+}
+static inline void* blockToPtr(const osHeapBlock* block) { return (u8*)block + HEAP_HEADER_SIZE; }
+static inline osHeapBlock* ptrToBlock(const void* ptr)  { return (osHeapBlock*)((u8*)ptr - HEAP_HEADER_SIZE); }
+static inline u32 heapFls(u32 x)                        { return 31U - (u32)__builtin_clz(x); }
+static inline u32 heapFfs(u32 x)                        { return (u32)__builtin_ctz(x); }
+
+
+bool osHeapInit(void* region, const u32 size)
+{
+    osHeapBlock* block;
+    osHeapBlock* sentinel;
+    u32 start;
+    u32 end;
+    u32 payload;
+
+    if (NULL == region) return false;
+
+    start = ((u32)region + OS_HEAP_ALIGN - 1U) & HEAP_SIZE_MASK;
+    end = ((u32)region + size) & HEAP_SIZE_MASK;
+    if (end <= start || end - start < 2U * HEAP_HEADER_SIZE + HEAP_MIN_PAYLOAD) return false;
+
+    /* One free block with all the region and the sentinel at the end */
+    payload = end - start - 2U * HEAP_HEADER_SIZE;
+    if (payload > HEAP_MAX_PAYLOAD) payload = HEAP_MAX_PAYLOAD;
+
+    heapLock();
+
+    memset(&heap, 0, sizeof(heap));
+
+    block = (osHeapBlock*)start;
+    block->prevPhys = NULL;
+    block->size = payload;
+
+    sentinel = blockNext(block);
+    sentinel->prevPhys = block;
+    sentinel->size = 0;
+
+    heap.totalSize = payload + 2U * HEAP_HEADER_SIZE;
+    heap.usedSize = HEAP_HEADER_SIZE;                       // The sentinel is never given back
+    heap.peakUsed = heap.usedSize;
+    heapInsert(block);
+    heap.initialized = true;
+
+    heapUnlock();
+
+    return true;
+}
+
+void* osHeapAlloc(const u32 size)
+{
+    osHeapBlock* block;
+    osHeapBlock* remainder;
+    u32 adjusted;
+    void* ptr = NULL;
+
+    heapLock();
+
+#if OS_HEAP_SIZE > 0
+    if (!heap.initialized) osHeapInit(heapRegion, sizeof(heapRegion));
+#endif
+
+    adjusted = heapAdjustSize(size);
+    block = (adjusted != 0) ? heapFindSuitable(adjusted) : NULL;
+
+    if (NULL != block)
+    {
+        heapRemove(block);
+
+        /* Give back what is left if it is big enough to be a block */
+        remainder = heapSplit(block, adjusted);
+        if (NULL != remainder) heapInsert(remainder);
+
+        block->size &= ~HEAP_FREE_FLAG;
+        heap.usedSize += HEAP_HEADER_SIZE + blockSize(block);
+        if (heap.usedSize > heap.peakUsed) heap.peakUsed = heap.usedSize;
+        heap.allocations++;
+        ptr = blockToPtr(block);
+    }
+    else
+    {
+        heap.failures++;
+    }
+
+    heapUnlock();
+
+    return ptr;
+}
+
+void osHeapFree(void* ptr)
+{
+    osHeapBlock* block;
+    osHeapBlock* prev;
+
+    if (NULL == ptr) return;
+
+    heapLock();
+
+    block = ptrToBlock(ptr);
+    heap.usedSize -= HEAP_HEADER_SIZE + blockSize(block);
+    heap.allocations--;
+    block->size |= HEAP_FREE_FLAG;
+
+    /* Merge with the neighbours so free memory is always kept in the biggest possible blocks */
+    prev = block->prevPhys;
+    if (NULL != prev && blockIsFree(prev))
+    {
+        heapRemove(prev);
+        block = heapMergeNext(prev);
+    }
+    if (blockIsFree(blockNext(block)))
+    {
+        heapRemove(blockNext(block));
+        block = heapMergeNext(block);
+    }
+
+    heapInsert(block);
+
+    heapUnlock();
+}
+
+void* osHeapRealloc(void* ptr, const u32 size)
+{
+    osHeapBlock* block;
+    osHeapBlock* next;
+    osHeapBlock* remainder;
+    u32 adjusted;
+    u32 current;
+    void* newPtr;
+
+    if (NULL == ptr) return osHeapAlloc(size);
+    if (0 == size)
+    {
+        osHeapFree(ptr);
+        return NULL;
+    }
+
+    adjusted = heapAdjustSize(size);
+    if (0 == adjusted) return NULL;
+
+    heapLock();
+
+    block = ptrToBlock(ptr);
+    current = blockSize(block);
+    next = blockNext(block);
+
+    /* Grow in place using the next block when it is free and big enough */
+    if (adjusted > current && blockIsFree(next) && current + HEAP_HEADER_SIZE + blockSize(next) >= adjusted)
+    {
+        heapRemove(next);
+        block->size = current + HEAP_HEADER_SIZE + blockSize(next);
+        blockNext(block)->prevPhys = block;
+        heap.usedSize += HEAP_HEADER_SIZE + blockSize(next);
+    }
+
+    if (adjusted <= blockSize(block))
+    {
+        /* Shrink: the tail becomes a free block, merged with the next one if possible */
+        remainder = heapSplit(block, adjusted);
+        if (NULL != remainder)
+        {
+            heap.usedSize -= HEAP_HEADER_SIZE + blockSize(remainder);
+            if (blockIsFree(blockNext(remainder)))
+            {
+                heapRemove(blockNext(remainder));
+                remainder = heapMergeNext(remainder);
+            }
+            heapInsert(remainder);
+        }
+        if (heap.usedSize > heap.peakUsed) heap.peakUsed = heap.usedSize;
+        heapUnlock();
+        return ptr;
+    }
+
+    heapUnlock();
+
+    /* Move it */
+    newPtr = osHeapAlloc(size);
+    if (NULL != newPtr)
+    {
+        memcpy(newPtr, ptr, current);
+        osHeapFree(ptr);
+    }
+    return newPtr;
+}
+
+u32 osHeapUsableSize(const void* ptr)
+{
+    if (NULL == ptr) return 0;
+    return blockSize(ptrToBlock(ptr));
+}
+
+void osHeapGetStats(osHeapStats* stats)
+{
+    osHeapBlock* block;
+    u32 largest = 0;
+    u32 fl;
+    u32 sl;
+
+    if (NULL == stats) return;
+
+    heapLock();
+
+    /* The biggest block is on the highest non empty list */
+    if (heap.flBitmap != 0)
+    {
+        fl = heapFls(heap.flBitmap);
+        sl = heapFls(heap.slBitmap[fl]);
+        for (block = heap.blocks[fl][sl]; NULL != block; block = block->nextFree)
+        {
+            if (blockSize(block) > largest) largest = blockSize(block);
+        }
+    }
+
+    stats->totalSize = heap.totalSize;
+    stats->usedSize = heap.usedSize;
+    stats->peakUsed = heap.peakUsed;
+    stats->freeSize = heap.totalSize - heap.usedSize;
+    stats->largestFree = largest;
+    stats->freeBlocks = heap.freeBlocks;
+    stats->allocations = heap.allocations;
+    stats->failures = heap.failures;
+
+    /* Free memory is counted without the headers of the free blocks */
+    if (stats->freeSize > heap.freeBlocks * HEAP_HEADER_SIZE)
+    {
+        u32 freePayload = stats->freeSize - heap.freeBlocks * HEAP_HEADER_SIZE;
+        stats->fragmentation = 100U - (u32)(((u64)largest * 100U) / freePayload);
+    }
+    else
+    {
+        stats->fragmentation = 0;
+    }
+
+    heapUnlock();
+}
+
+/**
+ * @brief Round the requested size to the alignment and the minimum payload. Returns 0 if it is too big.
+ */
+static u32 heapAdjustSize(u32 size)
+{
+    if (0 == size || size > HEAP_MAX_PAYLOAD) return 0;
+
+    size = (size + OS_HEAP_ALIGN - 1U) & HEAP_SIZE_MASK;
+    return (size < HEAP_MIN_PAYLOAD) ? HEAP_MIN_PAYLOAD : size;
+}
+
+/**
+ * @brief First and second level indexes of the list that holds blocks of this size.
+ */
+static void heapMapping(u32 size, u32* fl, u32* sl)
+{
+    u32 f;
+
+    if (size < HEAP_SMALL_SIZE)
+    {
+        *fl = 0;
+        *sl = size / (HEAP_SMALL_SIZE / OS_HEAP_SL_COUNT);
+    }
+    else
+    {
+        f = heapFls(size);
+        *sl = (size >> (f - OS_HEAP_SL_LOG2)) ^ OS_HEAP_SL_COUNT;
+        *fl = f - (OS_HEAP_FL_SHIFT - 1U);
+    }
+}
+
+/**
+ * @brief Find a free block of at least size bytes. The size is rounded up to the next list so
+ * any block of that list is big enough and the first one can be taken.
+ */
+static osHeapBlock* heapFindSuitable(u32 size)
+{
+    u32 fl;
+    u32 sl;
+    u32 slMap;
+    u32 flMap;
+
+    if (size >= HEAP_SMALL_SIZE)
+    {
+        size += (1U << (heapFls(size) - OS_HEAP_SL_LOG2)) - 1U;
+    }
+    heapMapping(size, &fl, &sl);
+    if (fl >= OS_HEAP_FL_COUNT) return NULL;
+
+    slMap = heap.slBitmap[fl] & (~0U << sl);
+    if (0 == slMap)
+    {
+        /* Nothing on this first level, take the smallest list of the next first level with blocks */
+        flMap = (fl + 1U < 32U) ? (heap.flBitmap & (~0U << (fl + 1U))) : 0;
+        if (0 == flMap) return NULL;
+
+        fl = heapFfs(flMap);
+        slMap = heap.slBitmap[fl];
+    }
+    sl = heapFfs(slMap);
+
+    return heap.blocks[fl][sl];
+}
+
+static void heapInsert(osHeapBlock* block)
+{
+    u32 fl;
+    u32 sl;
+
+    heapMapping(blockSize(block), &fl, &sl);
+
+    block->size |= HEAP_FREE_FLAG;
+    block->prevFree = NULL;
+    block->nextFree = heap.blocks[fl][sl];
+    if (NULL != block->nextFree) block->nextFree->prevFree = block;
+    heap.blocks[fl][sl] = block;
+
+    heap.flBitmap |= (1U << fl);
+    heap.slBitmap[fl] |= (1U << sl);
+    heap.freeBlocks++;
+}
+
+static void heapRemove(osHeapBlock* block)
+{
+    u32 fl;
+    u32 sl;
+
+    heapMapping(blockSize(block), &fl, &sl);
+
+    if (NULL != block->prevFree) block->prevFree->nextFree = block->nextFree;
+    else                         heap.blocks[fl][sl] = block->nextFree;
+    if (NULL != block->nextFree) block->nextFree->prevFree = block->prevFree;
+
+    if (NULL == heap.blocks[fl][sl])
+    {
+        heap.slBitmap[fl] &= ~(1U << sl);
+        if (0 == heap.slBitmap[fl]) heap.flBitmap &= ~(1U << fl);
+    }
+    heap.freeBlocks--;
+}
+
+/**
+ * @brief Cut the block to size bytes. Returns the remaining block (not inserted) or NULL if
+ * the remainder is too small to be a block.
+ */
+static osHeapBlock* heapSplit(osHeapBlock* block, u32 size)
+{
+    osHeapBlock* remainder;
+    u32 current = blockSize(block);
+    u32 flags = block->size & HEAP_FREE_FLAG;
+
+    if (current < size + HEAP_HEADER_SIZE + HEAP_MIN_PAYLOAD) return NULL;
+
+    block->size = size | flags;
+
+    remainder = blockNext(block);
+    remainder->prevPhys = block;
+    remainder->size = current - size - HEAP_HEADER_SIZE;
+    blockNext(remainder)->prevPhys = remainder;
+
+    return remainder;
+}
+
+/**
+ * @brief Absorb the next block (already removed from the free lists) into this one.
+ */
+static osHeapBlock* heapMergeNext(osHeapBlock* block)
+{
+    osHeapBlock* next = blockNext(block);
+
+    block->size += HEAP_HEADER_SIZE + blockSize(next);
+    blockNext(block)->prevPhys = block;
+
+    return block;
+}
+
+static void heapLock(void)
+{
+    u32 primask = __get_PRIMASK();
+
+    /* Allocations are bounded in time, so the heap is protected masking the IRQs. It can nest */
+    __disable_irq();
+    if (heapLockNesting++ == 0) heapLockPrimask = primask;
+}
+
+static void heapUnlock(void)
+{
+    if (--heapLockNesting == 0) __set_PRIMASK(heapLockPrimask);
+}
+
+/* -----------------------------  newlib hooks ----------------------------------- */
+
+struct _reent;
+
+void __malloc_lock(struct _reent* reent)
+{
+    heapLock();
+}
+
+void __malloc_unlock(struct _reent* reent)
+{
+    heapUnlock();
+}
+
+void* _malloc_r(struct _reent* reent, size_t size)
+{
+    return osHeapAlloc(size);
+}
+
+void _free_r(struct _reent* reent, void* ptr)
+{
+    osHeapFree(ptr);
+}
+
+void* _calloc_r(struct _reent* reent, size_t count, size_t size)
+{
+    void* ptr;
+    u64 total = (u64)count * size;
+
+    if (total > HEAP_MAX_PAYLOAD) return NULL;
+
+    ptr = osHeapAlloc((u32)total);
+    if (NULL != ptr) memset(ptr, 0, (u32)total);
+    return ptr;
+}
+
+void* _realloc_r(struct _reent* reent, void* ptr, size_t size)
+{
+    return osHeapRealloc(ptr, size);
+}
+
+size_t _malloc_usable_size_r(struct _reent* reent, void* ptr)
+{
+    return osHeapUsableSize(ptr);
+}
+
+#endif // OS_USE_HEAP
@@ -1,11 +1,19 @@
 #include "osKernel.h"
 #include "osQueue.h"
 #include "osSemaphore.h"
+#include "osTimer.h"
+#include "osSched.h"
+#if OS_USE_BENCHMARK
+#include "osBenchmark.h"
+#endif
+
+/* The scheduler policy is selected in osConfig.h and implemented by an osSched*.c file (see osSched.h) */
 
-// #define OS_SIMPLE
-#define OS_WITH_PRIORITY
+/* IPSR while SysTick_Handler runs */
+#define OS_SYSTICK_EXCEPTION    ((u32)(SysTick_IRQn + 16))
 
-osTaskObject idle;
+osTaskObject idle OS_CCMRAM;
+static OS_TASK_STACK_DEFINE(idleStack, OS_IDLE_STACK_SIZE) OS_CCMRAM;
 u8 osTasksCreated = 0;
 
 /**
@@ -17,48 +25,85 @@ typedef struct{
     osStatus osSystemStatus;                		// System status (Reset, Running, IRQ)
     u32 osScheduleExec;                     		// Execution flag
     bool yieldFromIsr;								// When calling a queue or semaphore API from IRQ
+    u32 osSwitchCount;                              // Context switches done by PendSV
+    u32 osSwitchAvoided;                            // Decisions of the tick or after a wakeup that kept the running task
+    bool osTaskWoken;                               // A task became ready since the last counted decision
     osTaskObject* osCurrTaskCallback;         		// Current task executing
     osTaskObject* osNextTaskCallback;         		// Next task to be executed
-    osTaskObject* osTaskList[OS_MAX_TASKS ];   		// List of tasks
-	osTaskObject* osTaskPriorityList[OS_MAX_TASKS];	// Task priorities
+    osTaskObject* osTaskList[OS_MAX_TASKS];   		// List of tasks created by the application (IDLE is not in it)
+    u8 osLastTaskID;                                // ID given to the last task created
+    osBudgetObject* osBudgetChunk;                  // Sporadic budget charged on the last tick, its chunk of execution is open
 }OsKernelCtrl;
 
-static OsKernelCtrl OsKernel;               		// Create an instance of the Kernel Control Structure
+static OsKernelCtrl OsKernel OS_CCMRAM;     		// Create an instance of the Kernel Control Structure
+
+/* Round-robin quantum in ticks of every priority level, filled by osStart (see timeSliceInit) */
+static u32 osTimeSlice[OS_MAX_PRIORITY] OS_CCMRAM;
 
 /* Private functions declarations */
 static void scheduler(void);
-static u32 getNextContext(u32 currentStaskPointer);
-void taskSortByPriority(u8 n);
-void osDelayCount(void);
-osTaskObject* findBlockedTaskFromSemaphore(osSemaphoreObject *sem);
-osTaskObject* findBlockedTaskFromQueue(u8 sender);
+static u32 getNextContext(u32 currentStaskPointer, u32 excReturn);
+static u32 getFirstContext(void);
+static void requestContextSwitch(bool tick);
+static void taskSetReady(osTaskObject* task);
+static void taskSetBlocked(osTaskObject* task, osBlockedOnType on, void* object);
+static void taskDispatch(osTaskObject* task);
+static void taskTimeoutCallback(void* arg);
+static void taskRemove(osTaskObject* task);
+static void taskExit(void);
+static osTaskObject* taskOrSelf(osTaskObject* task);
+static void periodicTask(void* arg);
+static void taskWaitRelease(osTaskObject* task);
+static void taskUpdateDeadline(osTaskObject* task, u32 absDeadline);
+static void budgetCharge(osTaskObject* task);
+static void budgetChunkEnd(osBudgetObject* budget);
+static void budgetExhaust(osTaskObject* task);
+static void budgetRestore(osTaskObject* task);
+static bool budgetSuspends(const osTaskObject* task);
+static void budgetReplenishCallback(void* arg);
+#if OS_USE_RATE_MONOTONIC && !defined(OS_WITH_EDF)
+static u32 rmPriority(u32 period, u32 candidate);
+static void rmAssignPriorities(void);
+#endif
+#if OS_USE_ADMISSION_CONTROL && !defined(OS_SIMPLE) && !defined(OS_WITH_TIME_PARTITION)
+static bool admissionTest(u32 period, u32 deadline, u32 wcet);
+#endif
+static osTaskObject* findBlockedTask(osBlockedOnType on, const void* object);
 osTaskObject* findRunningTask(void);
 void osYield(void);
-u8 checkForHighPriorityTask(u8 currIndex);
+static u32 getTimeSlice(const osTaskObject* task);
+static void timeSliceInit(void);
 
 
-bool osTaskCreate(osTaskObject* taskCtrlStruct, osPriorityType priority, void* taskFunction)
+bool osTaskCreate(osTaskObject* taskCtrlStruct, osPriorityType priority, void* taskFunction, void* arg, u32* stack, u32 stackSize)
 {
-    static u8 taskCount = 0;
+    u32* stackTop;
+    u32 primask;
+    bool isIdle = (taskCtrlStruct == &idle);
 
     /* Check that taskFunction and taskCtrlStruct is not NULL */
-    if (NULL == taskFunction || NULL == taskCtrlStruct)
+    if (NULL == taskFunction || NULL == taskCtrlStruct || (u32)priority >= OS_MAX_PRIORITY)
     {
         return false;
     }
 
-    /* If this is the first call, set osTaskList to NULL on each place */
-    if (taskCount == 0){
-        for (u8 i=0; i<OS_MAX_TASKS - 1; i++)
-        {
-            OsKernel.osTaskList[i] = NULL;
-        }
+    /* The stack must hold the first frame and keep the SP 8 bytes aligned (AAPCS) */
+    if (NULL == stack || stackSize < OS_MIN_STACK_SIZE || (stackSize & 0x7U) != 0 || ((u32)stack & 0x7U) != 0)
+    {
+        return false;
     }
-    /* If the taskList is full return Error. Added -2 because idle is task 8*/
-    else if (taskCount == (OS_MAX_TASKS - 2 )) 
+
+    /* If the taskList is full return Error. IDLE has its own place out of the list */
+    if (!isIdle && osTasksCreated >= OS_MAX_TASKS)
     {
         return false;
     }
+
+    /* The control block can be reused once its task was deleted, never while it is alive */
+    for (u8 i = 0; i < osTasksCreated; i++)
+    {
+        if (OsKernel.osTaskList[i] == taskCtrlStruct) return false;
+    }
     
     /*
                    STACK FRAME
@@ -67,7 +112,7 @@ bool osTaskCreate(osTaskObject* taskCtrlStruct, osPriorityType priority, void* t
         ---------------------------------
         |              PC               | <= Entry point (taskFunction address)
         ---------------------------------
-        |              LR               | <= EXEC_RETURN_VALUE
+        |              LR               | <= taskExit
         ---------------------------------
         |              R12              |
         ---------------------------------
@@ -77,9 +122,15 @@ bool osTaskCreate(osTaskObject* taskCtrlStruct, osPriorityType priority, void* t
         ---------------------------------
         |              R1               |
         ---------------------------------
-        |              R0               | <= MSP
+        |              R0               | <= arg
+        ---------------------------------
+        |       LR IRQ (EXEC_RETURN)    |
+        ---------------------------------
+        |              R11              |
+        ---------------------------------
+        |              ...              |
         ---------------------------------
-        |            LR IRQ             |
+        |              R4               | <= taskStackPointer (PSP)
         ---------------------------------
     */
 
@@ -88,83 +139,744 @@ bool osTaskCreate(osTaskObject* taskCtrlStruct, osPriorityType priority, void* t
         1) Set a 1 on bit 24 of xPSR to make sure we are executing THUMB instructions.
         2) PC must have the entry point (taskFunction in this case).
         3) Set the link register to EXEC_RETURN_VALUE to trigger.
+        4) LR of the task is taskExit, a task that returns is deleted.
+        5) R0 has the argument of the task, the first parameter of taskFunction (AAPCS).
     */
-    taskCtrlStruct->taskMemory[OS_MAX_STACK_SIZE/4 - XPSR_REG_POSITION]     = XPSR_VALUE;
-    taskCtrlStruct->taskMemory[OS_MAX_STACK_SIZE/4 - PC_REG_POSTION]        = (u32)taskFunction;
-    taskCtrlStruct->taskMemory[OS_MAX_STACK_SIZE/4 - LR_PREV_VALUE_POSTION] = EXEC_RETURN_VALUE;
+#if OS_USE_MPU_STACK_GUARD
+    /* The guard is a region of its own, so it must start on a region boundary. The task gets the rest */
+    if (((u32)stack & (OS_MPU_GUARD_SIZE - 1U)) != 0 || stackSize < OS_MIN_STACK_SIZE + OS_MPU_GUARD_SIZE)
+    {
+        return false;
+    }
+    taskCtrlStruct->taskStackGuard = ARM_MPU_RBAR(OS_MPU_GUARD_REGION, (u32)stack);
+    stack += OS_MPU_GUARD_SIZE / 4U;
+    stackSize -= OS_MPU_GUARD_SIZE;
+#endif
 
-    /* 				taskStackPointer =           (Address of first element)  +        64           -         17          =  */
-    taskCtrlStruct->taskStackPointer = (u32)(taskCtrlStruct->taskMemory + OS_MAX_STACK_SIZE/4 - OS_STACK_FRAME_SIZE);
+    taskCtrlStruct->taskStack = stack;
+    taskCtrlStruct->taskStackSize = stackSize;
+    stackTop = stack + stackSize/4;
+
+    /* Paint the stack, used by osTaskGetStackHighWater and the stack check. The lowest word is the canary */
+    for (u32* p = stack; p < stackTop; p++)
+    {
+        *p = OS_STACK_FILL_PATTERN;
+    }
+
+    stackTop[-XPSR_REG_POSITION]     = XPSR_VALUE;
+    stackTop[-PC_REG_POSTION]        = (u32)taskFunction;
+    stackTop[-LR_REG_POSTION]        = (u32)taskExit;
+    stackTop[-R0_REG_POSTION]        = (u32)arg;
+    stackTop[-LR_PREV_VALUE_POSTION] = EXEC_RETURN_VALUE;
+
+    /* 				taskStackPointer = (End of the stack) - 17 */
+    taskCtrlStruct->taskStackPointer = (u32)(stackTop - OS_STACK_FRAME_SIZE);
 
     taskCtrlStruct->taskEntryPoint = taskFunction;                                      // Assign the function to the Entry Point
-	//taskCtrlStruct->taskName = taskName;                                              // Assing the taskName
+    taskCtrlStruct->taskArg = arg;
+    taskCtrlStruct->taskPeriod = 0;                                                     // Not periodic, see osTaskCreatePeriodic
+    taskCtrlStruct->taskDeadline = 0;
+    taskCtrlStruct->taskRelease = 0;
+    taskCtrlStruct->taskAbsDeadline = 0;
+    taskCtrlStruct->taskDeadlineMisses = 0;
+    taskCtrlStruct->taskWcet = 0;
+    taskCtrlStruct->taskName[0] = '\0';                                                 // Without name until osTaskSetName
+    taskCtrlStruct->taskBlockedOn = OS_BLOCKED_NONE;
+    taskCtrlStruct->taskBlockedObject.object = NULL;
 	taskCtrlStruct->taskExecStatus = OS_TASK_READY;                                     // Set the task to Ready
-    taskCtrlStruct->taskPriority = priority;                                    		// Set the priority level to 1 (Not in used now)
+    taskCtrlStruct->taskUsesFpu = false;                                                // Tasks start without FPU context
+    taskCtrlStruct->taskTimeSlice = 0;                                                  // Use the quantum of the priority level
+    taskCtrlStruct->taskBudget = NULL;                                                  // Without budget, see osTaskSetBudget
+    taskCtrlStruct->taskPartition = 0;                                                  // See osTaskSetPartition
+    taskCtrlStruct->taskSliceLeft = 0;
+    taskCtrlStruct->taskPriority = priority;
+    taskCtrlStruct->taskPreemptThreshold = priority;                                    // Without threshold: any higher priority preempts
+    taskCtrlStruct->taskRunPriority = priority;                                         // Priority of the ready list of the task
+    osTimerInit(&taskCtrlStruct->timeout, taskTimeoutCallback, taskCtrlStruct);         // Timer used for delays and timeouts
+    taskCtrlStruct->readyNext = NULL;
+    taskCtrlStruct->readyPrev = NULL;
+
+    /* IDLE only runs when the ready lists are empty, it is not part of them */
+    if (isIdle)
+    {
+        taskCtrlStruct->taskID = 0;
+        return true;
+    }
 
-    OsKernel.osTaskList[taskCount] = taskCtrlStruct;                                    // Add the task structure to the list of tasks
-	taskCount++;                                                                        // Increment the task counter
-    taskCtrlStruct->taskID = taskCount;                                                 // Assing task ID starting from 1
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    taskCtrlStruct->taskListIndex = osTasksCreated;
+    OsKernel.osTaskList[osTasksCreated] = taskCtrlStruct;                               // Add the task structure to the list of tasks
+	osTasksCreated++;                                                                   // Increment the task counter
+    if (++OsKernel.osLastTaskID == 0) OsKernel.osLastTaskID = 1;                        // Assing task ID starting from 1, 0 is IDLE
+    taskCtrlStruct->taskID = OsKernel.osLastTaskID;
+    osSchedOnReady(taskCtrlStruct, false);
+
+    /* Created at run time with a higher priority than the caller, it runs now (nothing before osStart) */
+    if (osGetStatus() == OS_STATUS_RUNNING) osYield();
+
+    __set_PRIMASK(primask);
 
     return true;
 }
 
-void osStart(void)
+bool osTaskCreatePeriodic(osTaskObject* taskCtrlStruct, u32 period, u32 deadline, u32 wcet, void* jobFunction, void* arg, u32* stack, u32 stackSize)
 {
+    u32 primask;
 
-#ifdef OS_WITH_PRIORITY
-	// Count the number of tasks created
-	for (u8 i = 0 ; i < OS_MAX_TASKS - 1 ; i++)
-	{
-		if ( NULL != OsKernel.osTaskList[i]) osTasksCreated++;
-	}
-	taskSortByPriority(osTasksCreated);
-	osTaskCreate(&idle, OS_LOW_PRIORITY, osIdleTask);	 // Create IDLE task with the lowest priority
+    if (0 == deadline) deadline = period;
+    if (NULL == jobFunction || 0 == period || deadline > period || 0 == wcet || wcet > deadline)
+    {
+        return false;
+    }
+
+    /* The task can't run before its periodic fields are set */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+#if OS_USE_ADMISSION_CONTROL && !defined(OS_SIMPLE) && !defined(OS_WITH_TIME_PARTITION)
+    if (!admissionTest(period, deadline, wcet))
+    {
+        OsKernel.osLastError = OS_ERROR_NOT_SCHEDULABLE;
+        __set_PRIMASK(primask);
+        return false;
+    }
+#endif
+
+    if (!osTaskCreate(taskCtrlStruct, OS_NORMAL_PRIORITY, periodicTask, taskCtrlStruct, stack, stackSize))
+    {
+        __set_PRIMASK(primask);
+        return false;
+    }
+
+    /* It was created without deadline, the deadline selects the ready list with EDF */
+    osSchedOnBlock(taskCtrlStruct);
+
+    taskCtrlStruct->taskEntryPoint = jobFunction;
+    taskCtrlStruct->taskArg = arg;
+    taskCtrlStruct->taskPeriod = period;
+    taskCtrlStruct->taskDeadline = deadline;
+    taskCtrlStruct->taskWcet = wcet;
+    taskCtrlStruct->taskRelease = osTimerNow();                                         // The first job is released now
+    taskCtrlStruct->taskAbsDeadline = taskCtrlStruct->taskRelease + deadline;
+
+    osSchedOnReady(taskCtrlStruct, false);
+
+#if OS_USE_RATE_MONOTONIC && !defined(OS_WITH_EDF)
+    rmAssignPriorities();
+#endif
+
+    /* The decision of osTaskCreate was taken before the task had its deadline and its priority */
+    if (osGetStatus() == OS_STATUS_RUNNING) osYield();
+
+    __set_PRIMASK(primask);
+
+    return true;
+}
+
+/**
+ * @brief Body of every periodic task: runs one job per release.
+ */
+static void periodicTask(void* arg)
+{
+    osTaskObject* task = (osTaskObject*)arg;
+    void (*job)(void*) = (void (*)(void*))task->taskEntryPoint;
+
+    while(1)
+    {
+        job(task->taskArg);
+
+        osEnterCriticalSection();
+
+        /* Finishing on the tick of the deadline means that the deadline tick already passed */
+        if ((i32)(osTimerNow() - task->taskAbsDeadline) >= 0)
+        {
+            task->taskDeadlineMisses++;
+            OsKernel.osLastError = OS_ERROR_DEADLINE_MISS;
+            osDeadlineMissHook(task);
+        }
+
+        /* Releases are multiples of the period, never relative to the end of the job */
+        task->taskRelease += task->taskPeriod;
+        taskUpdateDeadline(task, task->taskRelease + task->taskDeadline);
+
+        osExitCriticalSection();
+
+        taskWaitRelease(task);
+    }
+}
+
+/**
+ * @brief Block the periodic task until the tick of its release. Returns at once if it already passed.
+ */
+static void taskWaitRelease(osTaskObject* task)
+{
+    osEnterCriticalSection();
+
+    /* Woken before the release (osTaskResume) it waits again */
+    while ((i32)(task->taskRelease - osTimerNow()) > 0)
+    {
+        taskSetBlocked(task, OS_BLOCKED_PERIOD, NULL);
+        osTimerStartAt(&task->timeout, task->taskRelease, 0);
+        osYield();
+
+        osExitCriticalSection();
+        osEnterCriticalSection();
+    }
+
+    osExitCriticalSection();
+}
+
+/**
+ * @brief Set the absolute deadline of the current job. A ready task is moved to its place on the
+ * ready lists, and the scheduler runs again if the earliest deadline changed.
+ */
+static void taskUpdateDeadline(osTaskObject* task, u32 absDeadline)
+{
+    u32 primask = __get_PRIMASK();
+    __disable_irq();
+
+    task->taskAbsDeadline = absDeadline;
+
+#if OS_SCHED_USES_DEADLINE
+    if (NULL != task->readyNext)
+    {
+        osSchedOnBlock(task);
+        osSchedOnReady(task, false);
+        osYield();
+    }
+#endif
+
+    __set_PRIMASK(primask);
+}
+
+bool osTaskSetDeadline(osTaskObject* task, const u32 deadline)
+{
+    u32 primask;
+    bool ready;
+
+    task = taskOrSelf(task);
+    if (NULL == task || task == &idle || 0 != task->taskPeriod) return false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* With or without deadline selects the ready list, so the task leaves the one it is in */
+    ready = (NULL != task->readyNext);
+    osSchedOnBlock(task);
+
+    task->taskDeadline = deadline;
+    task->taskAbsDeadline = osTimerNow() + deadline;
+
+    /* The running task stays the head of its priority list */
+    if (ready) osSchedOnReady(task, task == OsKernel.osCurrTaskCallback);
+    osYield();
+
+    __set_PRIMASK(primask);
+    return true;
+}
+
+bool osTaskSetBudget(osTaskObject* task, osBudgetObject* budget, u32 ticks, u32 period, osBudgetActionType action, osBudgetReplenishType replenish)
+{
+    u32 primask;
+    osBudgetObject* old;
+
+    if (NULL == task || task == &idle) return false;
+    if (NULL != budget && (0 == ticks || ticks > period || action > OS_BUDGET_HOOK || replenish > OS_BUDGET_SPORADIC))
+    {
+        return false;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* The previous budget stops, the task gets back what the action took from it */
+    old = task->taskBudget;
+    if (NULL != old)
+    {
+        osTimerStop(&old->timer);
+        if (OsKernel.osBudgetChunk == old) OsKernel.osBudgetChunk = NULL;
+        if (old->exhausted) budgetRestore(task);
+        task->taskBudget = NULL;
+    }
+
+    if (NULL != budget)
+    {
+        budget->budget = ticks;
+        budget->period = period;
+        budget->left = ticks;
+        budget->action = action;
+        budget->replenish = replenish;
+        budget->exhausted = false;
+        budget->suspended = false;
+        budget->demoted = false;
+        budget->savedPriority = task->taskPriority;
+        budget->overruns = 0;
+        budget->chunkStart = 0;
+        budget->chunkUsed = 0;
+        budget->replCount = 0;
+        osTimerInit(&budget->timer, budgetReplenishCallback, task);
+
+        /* A sporadic budget arms its timer when a chunk of execution ends */
+        if (OS_BUDGET_PERIODIC == replenish) osTimerStart(&budget->timer, period, period);
+
+        task->taskBudget = budget;
+    }
+
+    __set_PRIMASK(primask);
+    return true;
+}
+
+/**
+ * @brief Charge the current tick to the budget of the running task. Executed by SysTick.
+ */
+static void budgetCharge(osTaskObject* task)
+{
+    osBudgetObject* budget;
+
+    /* Before osStart there is no task to charge, the current one is NULL */
+    if (OsKernel.osSystemStatus != OS_STATUS_RUNNING || NULL == task) return;
+
+    budget = task->taskBudget;
+
+    /* The chunk of execution of a sporadic budget ends on the first tick that is not charged to it */
+    if (NULL != OsKernel.osBudgetChunk && OsKernel.osBudgetChunk != budget) budgetChunkEnd(OsKernel.osBudgetChunk);
+
+    if (NULL == budget || budget->exhausted) return;
+
+    if (OS_BUDGET_SPORADIC == budget->replenish && OsKernel.osBudgetChunk != budget)
+    {
+        /* The tick being charged started at the current tick of the wheel, osTimerTick advances it after the charge */
+        budget->chunkStart = osTimerNow();
+        budget->chunkUsed = 0;
+        OsKernel.osBudgetChunk = budget;
+    }
+
+    budget->chunkUsed++;
+    budget->left--;
+
+    if (0 == budget->left)
+    {
+        if (OsKernel.osBudgetChunk == budget) budgetChunkEnd(budget);
+        budgetExhaust(task);
+    }
+}
+
+/**
+ * @brief Sporadic: the ticks used by the chunk are given back one period after the chunk started.
+ */
+static void budgetChunkEnd(osBudgetObject* budget)
+{
+    u32 i;
+
+    OsKernel.osBudgetChunk = NULL;
+    if (0 == budget->chunkUsed) return;
+
+    if (budget->replCount < OS_BUDGET_MAX_REPLENISH)
+    {
+        i = budget->replCount++;
+        budget->replAmount[i] = 0;
+    }
+    else
+    {
+        /* Merged into the last one: given back later than due, never earlier */
+        i = budget->replCount - 1U;
+    }
+    budget->replTime[i] = budget->chunkStart + budget->period;
+    budget->replAmount[i] += budget->chunkUsed;
+    budget->chunkUsed = 0;
+
+    if (!osTimerIsActive(&budget->timer)) osTimerStartAt(&budget->timer, budget->replTime[0], 0);
+}
+
+/**
+ * @brief Executed by the timer wheel when the budget of the task is replenished.
+ */
+static void budgetReplenishCallback(void* arg)
+{
+    osTaskObject* task = (osTaskObject*)arg;
+    osBudgetObject* budget = task->taskBudget;
+
+    if (NULL == budget) return;
+
+    if (OS_BUDGET_PERIODIC == budget->replenish)
+    {
+        budget->left = budget->budget;
+    }
+    else
+    {
+        budget->left += budget->replAmount[0];
+        if (budget->left > budget->budget) budget->left = budget->budget;
+
+        budget->replCount--;
+        for (u32 i = 0; i < budget->replCount; i++)
+        {
+            budget->replTime[i] = budget->replTime[i + 1];
+            budget->replAmount[i] = budget->replAmount[i + 1];
+        }
+        if (0 != budget->replCount) osTimerStartAt(&budget->timer, budget->replTime[0], 0);
+    }
+
+    if (budget->exhausted && 0 != budget->left) budgetRestore(task);
+}
+
+/**
+ * @brief The action of the budget takes the task off the ready lists.
+ */
+static bool budgetSuspends(const osTaskObject* task)
+{
+    if (OS_BUDGET_SUSPEND == task->taskBudget->action) return true;
+#if OS_SCHED_USES_DEADLINE
+    /* A task scheduled by deadline can't be demoted */
+    if (OS_BUDGET_DEMOTE == task->taskBudget->action && 0 != task->taskDeadline) return true;
 #endif
+    return false;
+}
+
+static void budgetExhaust(osTaskObject* task)
+{
+    osBudgetObject* budget = task->taskBudget;
+
+    budget->exhausted = true;
+    budget->overruns++;
+
+    /* The flags are set after the calls: any other suspension or priority change clears them */
+    if (budgetSuspends(task))
+    {
+        budget->suspended = osTaskSuspend(task);
+    }
+    else if (OS_BUDGET_DEMOTE == budget->action)
+    {
+        budget->savedPriority = task->taskPriority;
+        budget->demoted = osTaskSetPriority(task, OS_LOW_PRIORITY);
+    }
+    else
+    {
+        osBudgetOverrunHook(task);
+    }
+}
 
-    /* Disable Systick and PendSV interrupts */
-    NVIC_DisableIRQ(SysTick_IRQn);
-    NVIC_DisableIRQ(PendSV_IRQn);
+/**
+ * @brief Undo only what budgetExhaust did: a suspension or a priority set by the application while the
+ * budget was exhausted is kept.
+ */
+static void budgetRestore(osTaskObject* task)
+{
+    osBudgetObject* budget = task->taskBudget;
+
+    budget->exhausted = false;
+
+    if (budget->suspended)
+    {
+        budget->suspended = false;
+        osTaskResume(task);
+    }
+    if (budget->demoted)
+    {
+        budget->demoted = false;
+        osTaskSetPriority(task, (osPriorityType)budget->savedPriority);
+    }
+}
+
+#if OS_USE_RATE_MONOTONIC && !defined(OS_WITH_EDF)
+/**
+ * @brief Rate monotonic: the priority of a period is the number of distinct shorter periods of the
+ * periodic tasks, counted from OS_RM_HIGHEST_PRIORITY. Equal periods share the priority.
+ * @param u32 candidate -> period of a task not created yet that is counted too, 0 for none
+ */
+static u32 rmPriority(u32 period, u32 candidate)
+{
+    u32 rank = 0;
+    bool candidateCounted = (0 == candidate || candidate >= period);
+
+    for (u8 j = 0; j < osTasksCreated; j++)
+    {
+        u32 other = OsKernel.osTaskList[j]->taskPeriod;
+        bool counted = false;
+
+        if (0 == other || other >= period) continue;
+        if (other == candidate) candidateCounted = true;
+
+        /* Count every shorter period once */
+        for (u8 k = 0; k < j; k++)
+        {
+            if (OsKernel.osTaskList[k]->taskPeriod == other)
+            {
+                counted = true;
+                break;
+            }
+        }
+        if (!counted) rank++;
+    }
+    if (!candidateCounted) rank++;
 
-    OsKernel.osSystemStatus = OS_STATUS_STOPPED;    // Set the System to STOPPED for the first time.
-    OsKernel.osCurrTaskCallback = NULL;      		// Set the Current task to NULL the first time. This will be handled by the scheduler
+    rank += OS_RM_HIGHEST_PRIORITY;
+    return (rank > OS_RM_LOWEST_PRIORITY) ? OS_RM_LOWEST_PRIORITY : rank;
+}
+
+/**
+ * @brief Assign again the priorities of all the periodic tasks from their periods.
+ */
+static void rmAssignPriorities(void)
+{
+    osTaskObject* task;
+    u32 prio;
+
+    for (u8 i = 0; i < osTasksCreated; i++)
+    {
+        task = OsKernel.osTaskList[i];
+        if (0 == task->taskPeriod) continue;
+
+        prio = rmPriority(task->taskPeriod, 0);
+        if (task->taskPriority != prio) osTaskSetPriority(task, (osPriorityType)prio);
+    }
+}
+#endif
+
+#if OS_USE_ADMISSION_CONTROL && !defined(OS_SIMPLE) && !defined(OS_WITH_TIME_PARTITION)
+/**
+ * @brief Schedulability test of the periodic tasks plus a new one, with their declared WCET.
+ * EDF: the density, sum of wcet/deadline, can't be over 1 (the utilization when deadline is the period).
+ * Fixed priority: response time analysis, the worst case response of every task is its wcet plus the
+ * interference of the tasks of higher or equal priority (round-robin), and must not exceed its deadline.
+ * Tasks that are not periodic, blocking and the preemption threshold are not taken into account.
+ */
+static bool admissionTest(u32 period, u32 deadline, u32 wcet)
+{
+#ifdef OS_WITH_EDF
+    /* Fixed point with 20 fractional bits, rounded up so rounding never admits an overloaded set */
+    u64 density = (((u64)wcet << 20) + deadline - 1U) / deadline;
+
+    for (u8 i = 0; i < osTasksCreated; i++)
+    {
+        osTaskObject* task = OsKernel.osTaskList[i];
+        if (0 == task->taskPeriod) continue;
+        density += (((u64)task->taskWcet << 20) + task->taskDeadline - 1U) / task->taskDeadline;
+    }
+
+    return density <= (1U << 20);
+#else
+    /* The new task is the last one of the set */
+    static struct{
+        u32 period;
+        u32 deadline;
+        u32 wcet;
+        u32 priority;
+    }set[OS_MAX_TASKS + 1] OS_CCMRAM;
+    u32 n = 0;
+
+    for (u8 i = 0; i < osTasksCreated; i++)
+    {
+        osTaskObject* task = OsKernel.osTaskList[i];
+        if (0 == task->taskPeriod) continue;
+        set[n].period = task->taskPeriod;
+        set[n].deadline = task->taskDeadline;
+        set[n].wcet = task->taskWcet;
+#if OS_USE_RATE_MONOTONIC
+        set[n].priority = rmPriority(task->taskPeriod, period);
+#else
+        set[n].priority = task->taskPriority;
+#endif
+        n++;
+    }
+    set[n].period = period;
+    set[n].deadline = deadline;
+    set[n].wcet = wcet;
+#if OS_USE_RATE_MONOTONIC
+    set[n].priority = rmPriority(period, 0);
+#else
+    set[n].priority = OS_NORMAL_PRIORITY;
+#endif
+    n++;
+
+    for (u32 i = 0; i < n; i++)
+    {
+        u32 response = set[i].wcet;
+        u32 prev;
+
+        /* R = C + sum(ceil(R / Tj) * Cj), from R = C until it converges or passes the deadline */
+        do
+        {
+            prev = response;
+            response = set[i].wcet;
+            for (u32 j = 0; j < n; j++)
+            {
+                if (j == i || set[j].priority > set[i].priority) continue;
+                response += ((prev + set[j].period - 1U) / set[j].period) * set[j].wcet;
+            }
+            if (response > set[i].deadline) return false;
+        } while (response != prev);
+    }
+
+    return true;
+#endif
+}
+#endif
+
+u32 osTaskGetDeadlineMisses(const osTaskObject* task)
+{
+    return (NULL != task) ? task->taskDeadlineMisses : 0;
+}
+
+void osStart(void)
+{
+#if OS_USE_BENCHMARK
+    osBenchInit();
+    osBenchStartup = osBenchCycles();
+#endif
+
+	osTaskCreate(&idle, OS_LOW_PRIORITY, osIdleTask, NULL, OS_TASK_STACK(idleStack));	 // Create IDLE task with the lowest priority
+
+    /*
+     * HAL_Init already started SysTick for the HAL time base. It is stopped until the first task is
+     * launched, and a tick or a context switch that was already pending is discarded, so neither
+     * SysTick nor PendSV can run before the kernel is ready.
+     * (NVIC_DisableIRQ can't be used: SysTick and PendSV are system exceptions, their IRQn is negative.)
+     */
+    SysTick->CTRL = 0;
+    SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk | SCB_ICSR_PENDSVCLR_Msk;
+
+    OsKernel.osSystemStatus = OS_STATUS_STOPPED;    // Set the System to STOPPED until the first task is launched
+    /* A policy with a wrong configuration (OS_PARTITION_TABLE) never launches the tasks */
+    if (!osSchedInit())
+    {
+        OsKernel.osLastError = OS_ERROR_SCHED_CONFIG;
+        osErrorHook(NULL);
+        while(1)
+        {
+        }
+    }
+
+    timeSliceInit();
+
+    /* The first pick of the policy runs first */
+    OsKernel.osCurrTaskCallback = osSchedPickNext(&idle);
+    if (NULL == OsKernel.osCurrTaskCallback) OsKernel.osCurrTaskCallback = &idle;
     OsKernel.osNextTaskCallback = NULL;      		// Set the Next task to NULL the first time. This will be handled by the scheduler
     OsKernel.yieldFromIsr = false;
+    OsKernel.osSwitchCount = 0;
+    OsKernel.osSwitchAvoided = 0;
+    OsKernel.osTaskWoken = false;
+#if OS_USE_MPU_STACK_GUARD
+    /*
+     * The attributes of the guard region are written once, PendSV only moves its base address.
+     * PRIVDEFENA keeps the default memory map for everything else.
+     */
+    ARM_MPU_Disable();
+    ARM_MPU_SetRegion(OsKernel.osCurrTaskCallback->taskStackGuard,
+                      ARM_MPU_RASR(1U, ARM_MPU_AP_NONE, 0U, 1U, 1U, 0U, 0U, ARM_MPU_REGION_SIZE_32B));
+    ARM_MPU_Enable(MPU_CTRL_PRIVDEFENA_Msk);
+#endif
+
+#if (__FPU_USED == 1U)
+    /*
+     * Automatic and lazy FPU state preservation: the extended frame is only used by tasks that executed
+     * FPU instructions (EXEC_RETURN[4] = 0), and s0-s15 are only written to it if the handler uses the FPU.
+     */
+    FPU->FPCCR |= FPU_FPCCR_ASPEN_Msk | FPU_FPCCR_LSPEN_Msk;
+#endif
+
     /* Is mandatory to set the PendSV priority as lowest as possible */
     NVIC_SetPriority(PendSV_IRQn, (1 << __NVIC_PRIO_BITS)-1);
 
-    /* Activate and config the Systick exception */
+    /* SysTick is started again by getFirstContext (SVC 0), with the OS tick, when the first task is launched */
     SystemCoreClockUpdate();
+
+    /*
+     * Nothing of main is used anymore, so MSP goes back to the initial value of the vector table and
+     * becomes the stack of the handlers. SVC 0 launches the first task, this function never returns.
+     * The SVC can't be taken with PRIMASK set, so the IRQs are enabled before it.
+     */
+    __ASM volatile (
+        "msr msp, %0    \n\t"
+        "cpsie i        \n\t"
+        "dsb            \n\t"
+        "isb            \n\t"
+        "svc 0          \n\t"
+        :: "r"(*(u32*)SCB->VTOR) : "memory"
+    );
+
+    while(1)
+    {
+    }
+}
+
+/**
+ * @brief Called by SVC_Handler, prepares the first task and returns its stack pointer.
+ */
+static u32 getFirstContext(void)
+{
+    taskDispatch(OsKernel.osCurrTaskCallback);
+    OsKernel.osCurrTaskCallback->taskSliceLeft = getTimeSlice(OsKernel.osCurrTaskCallback);
+    OsKernel.osSystemStatus = OS_STATUS_RUNNING;
+
+#if OS_USE_MPU_STACK_GUARD
+    MPU->RBAR = OsKernel.osCurrTaskCallback->taskStackGuard;
+    __DSB();
+#endif
+
+    /* The first tick comes a full period after the first task starts */
     SysTick_Config(SystemCoreClock / OS_SYSTICK_TICK);
 
-    /* Enable Systick and PendSV interrupts */
-    NVIC_EnableIRQ(PendSV_IRQn);
-    NVIC_EnableIRQ(SysTick_IRQn);
+#if OS_USE_BENCHMARK
+    osBenchStartup = osBenchCycles() - osBenchStartup;
+#endif
+
+    return OsKernel.osCurrTaskCallback->taskStackPointer;
 }
 
-static u32 getNextContext(u32 currentStaskPointer)
+/**
+  * @brief This function handles System service call via SWI instruction.
+  * SVC 0 (the only service) is used by osStart to launch the first task.
+  */
+NAKED void SVC_Handler(void)
 {
-     // Is the first time execute operating system? Yes, so will do task charged on next task.
-    if (OsKernel.osSystemStatus != OS_STATUS_RUNNING)
-    {
-        OsKernel.osCurrTaskCallback->taskExecStatus = OS_TASK_RUNNING;
-        OsKernel.osSystemStatus = OS_STATUS_RUNNING;
-        return OsKernel.osCurrTaskCallback->taskStackPointer;
-    }
+    /*
+     * Se restaura el contexto inicial de la primera tarea de la misma forma que en PendSV_Handler
+     * y se retorna a modo thread con PSP usando el EXEC_RETURN guardado en su stack.
+     */
+    __ASM volatile ("bl %0" :: "i"(getFirstContext));
+    __ASM volatile ("ldmia r0!, {r4-r11, lr}");
+    __ASM volatile ("msr psp, r0");
+    __ASM volatile ("bx lr");
+}
 
+static u32 getNextContext(u32 currentStaskPointer, u32 excReturn)
+{
     // Storage last stack pointer used on current task and change state to ready.
     OsKernel.osCurrTaskCallback->taskStackPointer = currentStaskPointer;
-	if (OsKernel.osCurrTaskCallback->delay != 0 || OsKernel.osCurrTaskCallback->taskExecStatus == OS_TASK_BLOCKED)
-	{
-		// Do nothing
-	}
-	else
+
+    /* EXEC_RETURN[4] = 0: the task has FPU context, its frame is extended and s16-s31 were saved */
+    OsKernel.osCurrTaskCallback->taskUsesFpu = ((excReturn & EXEC_RETURN_FPU_MSK) == 0);
+
+#if OS_USE_STACK_CHECK
+    /* The task went below its stack if the canary was overwritten or the SP is out of the stack */
+    if (OsKernel.osCurrTaskCallback->taskStack[0] != OS_STACK_FILL_PATTERN ||
+        currentStaskPointer < (u32)OsKernel.osCurrTaskCallback->taskStack)
+    {
+        OsKernel.osLastError = OS_ERROR_STACK_OVERFLOW;
+        osErrorHook(OsKernel.osCurrTaskCallback);
+    }
+#endif
+	/* A blocked or deleted task keeps its status */
+	if (OsKernel.osCurrTaskCallback->taskExecStatus == OS_TASK_RUNNING)
 	{
     	OsKernel.osCurrTaskCallback->taskExecStatus = OS_TASK_READY;
 	}
 
+    /* PendSV is also pended when the running task blocks, it may be woken again before PendSV runs */
+    if (OsKernel.osNextTaskCallback != OsKernel.osCurrTaskCallback) OsKernel.osSwitchCount++;
+
     // Switch address memory points on current task for next task and change state of task
     OsKernel.osCurrTaskCallback = OsKernel.osNextTaskCallback;
-    OsKernel.osCurrTaskCallback->taskExecStatus = OS_TASK_RUNNING;
+    taskDispatch(OsKernel.osCurrTaskCallback);
+
+#if OS_USE_MPU_STACK_GUARD
+    /* One store moves the guard below the new stack (RBAR.VALID selects the region), the DSB makes it effective before the unstacking */
+    MPU->RBAR = OsKernel.osCurrTaskCallback->taskStackGuard;
+    __DSB();
+#endif
 
     return OsKernel.osCurrTaskCallback->taskStackPointer;
 }
@@ -175,100 +887,75 @@ static u32 getNextContext(u32 currentStaskPointer)
  */
 static void scheduler(void)
 {
-	/* Start osTaskLastPriExec with 1 so it will start from the highest priority */
-    static u8 osTaskIndex = 0;
-	static u8 status[OS_MAX_TASKS];
-	osTaskStatusType taskStatus;
-    static u8 schedulerCount = 0;
-
+    osTaskObject* next;
+    u32 primask;
 
-    /* First we need to check if the kernel is running */
+    /* First we need to check if the kernel is running, the first task is launched by osStart */
     if (OsKernel.osSystemStatus != OS_STATUS_RUNNING)
     {
-        OsKernel.osCurrTaskCallback = OsKernel.osTaskList[0];
-        // osTaskIndex++;
         return;
     }
 
-#ifdef OS_SIMPLE
-    /* If the next index in osTaskList is NULL then we did a full round table.
-     * So we need to go back to the first task in the list
-     * This implementation is for Round-Robin
-     */
-    if (NULL != OsKernel.osTaskList[osTaskIndex] && osTaskIndex < (OS_MAX_TASKS))
-    {   
-        OsKernel.osNextTaskCallback = OsKernel.osTaskList[osTaskIndex];
-        osTaskIndex++;
-    }
-    else
-    {   
-        /* If we are in this point is because we already did a round table */
-        OsKernel.osNextTaskCallback = OsKernel.osTaskList[0];
-        osTaskIndex = 0;
-    }
-#else
-	u8 n = 0;
+    /* The pick may rotate a ready list, which the APIs called from higher priority IRQs also change */
+    primask = __get_PRIMASK();
+    __disable_irq();
 
-	/* Check if all the tasks are in Blocked state */
-	for (u8 idx = 0; idx < osTasksCreated; idx++)
-	{
-		if (OsKernel.osTaskList[idx]->taskExecStatus == OS_TASK_BLOCKED)
-		{
-			n++;
-		}
-	}
-	
-	/* If all the tasks are blocked, assign the last task (IDLE) to the next task */
-	if (n == osTasksCreated)
-	{
-		/* Assign the IDLE task to be executed. IDLE task is the last osTaskCreated so it is at that index */
-		if (OsKernel.osCurrTaskCallback != OsKernel.osTaskList[osTasksCreated])
-		{
-			OsKernel.osNextTaskCallback = OsKernel.osTaskList[osTasksCreated];
+    /* IDLE if the policy has nothing ready */
+    next = osSchedPickNext(OsKernel.osCurrTaskCallback);
+    if (NULL == next) next = &idle;
+
+    /* A preempted task keeps the rest of its slice, otherwise it starts a new one */
+    if (0 == next->taskSliceLeft) next->taskSliceLeft = getTimeSlice(next);
+
+    OsKernel.osNextTaskCallback = next;
+
+    __set_PRIMASK(primask);
+}
 
-			/* Set the osTaskIndex to the IDLE task */
-			osTaskIndex = osTasksCreated;
-		}
-		return;
-	}
-    
-    /* Iterate between all the tasks to determine which should be the next to be executed */
-	// taskStatus = OsKernel.osTaskList[idx]->taskExecStatus;
-    osTaskIndex++;
-    osTaskIndex = osTaskIndex % osTasksCreated;
-    if (OsKernel.osTaskList[osTaskIndex]->taskExecStatus == OS_TASK_READY)
+/**
+ * @brief Every level gets its entry of OS_TIME_SLICE_TABLE. Without it, every level gets OS_TIME_SLICE
+ * and then the named levels configured in osConfig.h their own one. With less than 4 levels some
+ * named levels are the same level, the higher one is written last and wins.
+ */
+static void timeSliceInit(void)
+{
+#ifdef OS_TIME_SLICE_TABLE
+    static const u32 table[] = OS_TIME_SLICE_TABLE;
+
+    _Static_assert(sizeof(table) / sizeof(table[0]) == OS_MAX_PRIORITY,
+                   "OS_TIME_SLICE_TABLE must have one entry per priority level (OS_MAX_PRIORITY)");
+
+    for (u32 i = 0; i < OS_MAX_PRIORITY; i++)
     {
-        osTaskIndex = checkForHighPriorityTask(osTaskIndex);
-        OsKernel.osNextTaskCallback = OsKernel.osTaskList[osTaskIndex];
-        schedulerCount = 0;
+        /* A quantum of 0 ticks is not possible, it is the one of every tick */
+        osTimeSlice[i] = (0 != table[i]) ? table[i] : 1U;
     }
-    else
+#else
+    for (u32 i = 0; i < OS_MAX_PRIORITY; i++)
     {
-    	if (OsKernel.osTaskList[osTaskIndex] != OsKernel.osTaskList[osTasksCreated])
-    	{
-			schedulerCount++;
-			if (schedulerCount == osTasksCreated)
-			{
-				schedulerCount = 0;
-				OsKernel.osNextTaskCallback = findRunningTask(); // Keep running the task that is OS_TASK_RUNNING
-				return;
-			}
-			scheduler();
-    	}
+        osTimeSlice[i] = OS_TIME_SLICE;
     }
+#ifdef OS_TIME_SLICE_LOW
+    osTimeSlice[OS_LOW_PRIORITY] = OS_TIME_SLICE_LOW;
+#endif
+#ifdef OS_TIME_SLICE_NORMAL
+    osTimeSlice[OS_NORMAL_PRIORITY] = OS_TIME_SLICE_NORMAL;
+#endif
+#ifdef OS_TIME_SLICE_HIGH
+    osTimeSlice[OS_HIGH_PRIORITY] = OS_TIME_SLICE_HIGH;
+#endif
+#ifdef OS_TIME_SLICE_VERYHIGH
+    osTimeSlice[OS_VERYHIGH_PRIORITY] = OS_TIME_SLICE_VERYHIGH;
+#endif
 #endif
 }
 
-u8 checkForHighPriorityTask(u8 currIndex)
+/**
+ * @brief Quantum of the task in ticks: its own one or the one of its priority level.
+ */
+static u32 getTimeSlice(const osTaskObject* task)
 {
-    for (u8 idx = 0; idx < currIndex; idx++)
-    {
-        if(OsKernel.osTaskList[idx]->taskPriority < OsKernel.osTaskList[currIndex]->taskPriority && OsKernel.osTaskList[idx]->taskExecStatus == OS_TASK_READY)
-        {
-            return idx;
-        }
-    }
-    return currIndex;
+    return (0 != task->taskTimeSlice) ? task->taskTimeSlice : osTimeSlice[task->taskPriority];
 }
 
 /**
@@ -278,48 +965,53 @@ NAKED void PendSV_Handler(void)
 {
     // Se entra a la seccion critica y se deshabilita las interrupciones.
 	__ASM volatile ("cpsid i");
+#if OS_USE_BENCHMARK
+    __ASM volatile ("push {r0, lr}");
+    __ASM volatile ("mov r0, lr");
+    __ASM volatile ("bl %0" :: "i"(osBenchPendSVStart));
+    __ASM volatile ("pop {r0, lr}");
+#endif
     /**
+     * Las tareas corren sobre PSP (EXEC_RETURN 0xFFFFFFFD) y los handlers sobre MSP, por lo que el
+     * contexto de la tarea se guarda en su propio stack con stmdb/ldmia sobre PSP y el MSP no se toca.
+     *
      * Implementación de stacking para FPU:
+     * La instruccion TST hace un AND bit a bit entre LR (EXEC_RETURN) y el literal inmediato. Si el
+     * bit EXEC_RETURN[4] = 0 la bandera Z = 1, se da la condicion EQ y se guardan los registros de FPU
+     * s16-s31 que el hardware no apila.
      *
-     * Las tres primeras corresponden a un testeo del bit EXEC_RETURN[4]. La instruccion TST hace un
-     * AND estilo bitwise (bit a bit) entre el registro LR y el literal inmediato. El resultado de esta
-     * operacion no se guarda y los bits N y Z son actualizados. En este caso, si el bit EXEC_RETURN[4] = 0
-     * el resultado de la operacion sera cero, y la bandera Z = 1, por lo que se da la condicion EQ y
-     * se hace el push de los registros de FPU restantes
+     * Luego se guardan R4-R11 y LR, que en este punto es EXEC_RETURN. stmdb deja LR en la posicion 9
+     * (luego del stack frame) y R4 en la posicion 17, que es el SP que se guarda en la tarea.
+     * El pasaje de argumentos a getNextContext se hace como especifica el AAPCS: el SP en R0 y
+     * EXEC_RETURN en R1 (uso de FPU de la tarea). El valor de retorno se almacena en R0
      */
+    __ASM volatile ("mrs r0, psp");
     __ASM volatile ("tst lr, 0x10");
     __ASM volatile ("it eq");
-    __ASM volatile ("vpusheq {s16-s31}");
-
-    /**
-     * Cuando se ingresa al handler de PendSV lo primero que se ejecuta es un push para
-	 * guardar los registros R4-R11 y el valor de LR, que en este punto es EXEC_RETURN
-	 * El push se hace al reves de como se escribe en la instruccion, por lo que LR
-	 * se guarda en la posicion 9 (luego del stack frame). Como la funcion getNextContext
-	 * se llama con un branch con link, el valor del LR es modificado guardando la direccion
-	 * de retorno una vez se complete la ejecucion de la funcion
-	 * El pasaje de argumentos a getContextoSiguiente se hace como especifica el AAPCS siendo
-	 * el unico argumento pasado por RO, y el valor de retorno tambien se almacena en R0
-	 *
-	 * NOTA: El primer ingreso a este handler (luego del reset) implica que el push se hace sobre el
-	 * stack inicial, ese stack se pierde porque no hay seguimiento del MSP en el primer ingreso
-     */
-    __ASM volatile ("push {r4-r11, lr}");
-    __ASM volatile ("mrs r0, msp");
+    __ASM volatile ("vstmdbeq r0!, {s16-s31}");
+    __ASM volatile ("stmdb r0!, {r4-r11, lr}");
+    __ASM volatile ("mov r1, lr");
     __ASM volatile ("bl %0" :: "i"(getNextContext));
-    __ASM volatile ("msr msp, r0");
-    __ASM volatile ("pop {r4-r11, lr}");    //Recuperados todos los valores de registros
+    __ASM volatile ("ldmia r0!, {r4-r11, lr}");    //Recuperados todos los valores de registros
 
     /**
      * Implementación de unstacking para FPU:
      *
      * Habiendo hecho el cambio de contexto y recuperado los valores de los registros, es necesario
      * determinar si el contexto tiene guardados registros correspondientes a la FPU. si este es el caso
-     * se hace el unstacking de los que se hizo PUSH manualmente.
+     * se hace el unstacking de los que se guardaron manualmente.
      */
-    __ASM volatile ("tst lr,0x10");
+    __ASM volatile ("tst lr, 0x10");
     __ASM volatile ("it eq");
-    __ASM volatile ("vpopeq {s16-s31}");
+    __ASM volatile ("vldmiaeq r0!, {s16-s31}");
+    __ASM volatile ("msr psp, r0");
+
+#if OS_USE_BENCHMARK
+    __ASM volatile ("push {r0, lr}");
+    __ASM volatile ("mov r0, lr");
+    __ASM volatile ("bl %0" :: "i"(osBenchPendSVEnd));
+    __ASM volatile ("pop {r0, lr}");
+#endif
 
     // Se sale de la seccion critica y se habilita las interrupciones.
 	__ASM volatile ("cpsie i");
@@ -335,24 +1027,43 @@ NAKED void PendSV_Handler(void)
   */
 void SysTick_Handler(void)
 {
+#if OS_USE_BENCHMARK
+    u32 cycles = osBenchCycles();
+#endif
+    u32 primask;
+
+    /* Nothing to do until the first task is launched: before it there is no current task */
+    if (OsKernel.osSystemStatus != OS_STATUS_RUNNING)
+    {
+        return;
+    }
+
+    /*
+     * The slice, the budget, the ready lists and the next task are also changed by the APIs that can
+     * be called from IRQs (osSemaphoreGive, osTaskSuspend/Resume...), which may preempt SysTick.
+     */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* Charge the tick to the slice and to the budget of the running task */
+    if (OsKernel.osCurrTaskCallback->taskSliceLeft > 0) OsKernel.osCurrTaskCallback->taskSliceLeft--;
+    budgetCharge(OsKernel.osCurrTaskCallback);
+
+    /* Time driven decisions of the policy, before the scheduler runs */
+    osSchedOnTick();
+
+    /* Expire the delays, timeouts and software timers of this tick so the woken tasks can be scheduled now */
+    osTimerTick();
+
     scheduler();
 
-	/* Check if there is any task blocked and with a delay */
-	osDelayCount();
+    requestContextSwitch(true);
 
+    __set_PRIMASK(primask);
 
 	/* This is a function that can be used by the User after the scheduler does it's job */
 	osSysTickHook();
 
-    /*  We need to manipulate the ICSR register (Interrupt Control and State Register)
-     *  Bit 28 is the PENSVSET mask
-     *  If we WRITE a 0 = Pending exception is not pending
-     *  If we WRITE a 1 = Pending exception is pending
-     *  So this works as a trigger for the PendSV (Pending Service Call) that we need for a context change
-     */
-    SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
-
-
     /*
      * Instruction Synchronization Barrier; flushes the pipeline and ensures that
      * all previous instructions are completed before executing new instructions
@@ -365,51 +1076,168 @@ void SysTick_Handler(void)
      */
     __DSB();
 
+#if OS_USE_BENCHMARK
+    osBenchCounterAdd(&osBenchSysTick, osBenchCycles() - cycles);
+#endif
 }
 
 
 /**
- * @brief Private function that will sort the tasks by priorities. 
+ * @brief Trigger the context switch only if the scheduler picked another task, saving the
+ * full save/restore of PendSV when the running task keeps the CPU. The switches are counted by
+ * getNextContext, here only the decisions that could have switched and didn't: the ones of the tick
+ * and the ones after a task became ready.
+ * @param bool tick -> called by SysTick_Handler
  */
-void taskSortByPriority(u8 n)
-{	
-	osTaskObject *temp = NULL;
-    for (u8 i = 0; i < n - 1; i++) {
-        for (u8 j = 0; j < n - i - 1; j++) 
-		{
-            if (OsKernel.osTaskList[j]->taskPriority > OsKernel.osTaskList[j + 1]->taskPriority) 
-			{
-                temp = OsKernel.osTaskList[j];
-                OsKernel.osTaskList[j] = OsKernel.osTaskList[j + 1];
-                OsKernel.osTaskList[j + 1] = temp;
-            }
-        }
-	}
+static void requestContextSwitch(bool tick)
+{
+    bool pend = (OsKernel.osNextTaskCallback != OsKernel.osCurrTaskCallback ||
+                 OsKernel.osCurrTaskCallback->taskExecStatus != OS_TASK_RUNNING);
+
+    if (pend)
+    {
+        /*  We need to manipulate the ICSR register (Interrupt Control and State Register)
+         *  Bit 28 is the PENSVSET mask
+         *  If we WRITE a 0 = Pending exception is not pending
+         *  If we WRITE a 1 = Pending exception is pending
+         *  So this works as a trigger for the PendSV (Pending Service Call) that we need for a context change
+         */
+        SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+    }
+
+    /* The yields inside SysTick (timeouts, budgets) are part of the decision of the tick, counted once by it */
+    if (!tick && OS_SYSTICK_EXCEPTION == __get_IPSR()) return;
+
+    if (!pend && (tick || OsKernel.osTaskWoken)) OsKernel.osSwitchAvoided++;
+    OsKernel.osTaskWoken = false;
+}
+
+/**
+ * @brief A blocked task can run again, it goes to the tail of the list of its priority.
+ */
+static void taskSetReady(osTaskObject* task)
+{
+    /* The queue and semaphore APIs don't mask the IRQs when they are called from an IRQ */
+    u32 primask = __get_PRIMASK();
+    __disable_irq();
+
+    task->taskExecStatus = OS_TASK_READY;
+    task->taskRunPriority = task->taskPriority;
+    task->taskBlockedOn = OS_BLOCKED_NONE;
+    task->taskBlockedObject.object = NULL;
+    osSchedOnReady(task, false);
+    OsKernel.osTaskWoken = true;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief The task leaves the ready lists waiting for object. It gives up the rest of its slice and its preemption threshold.
+ */
+static void taskSetBlocked(osTaskObject* task, osBlockedOnType on, void* object)
+{
+    u32 primask = __get_PRIMASK();
+    __disable_irq();
+
+    osSchedOnBlock(task);
+    task->taskExecStatus = OS_TASK_BLOCKED;
+    task->taskBlockedOn = on;
+    task->taskBlockedObject.object = object;
+    task->taskSliceLeft = 0;
+    task->taskRunPriority = task->taskPriority;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief The task gets the CPU. From now on it competes with its preemption threshold.
+ */
+static void taskDispatch(osTaskObject* task)
+{
+    task->taskExecStatus = OS_TASK_RUNNING;
+
+    if (task != &idle) osSchedOnDispatch(task);
 }
 
 /**
- *	@brief This function decrement the time if a task is blocked and there is a delay on it. 
+ *	@brief Executed by the timer wheel when a delay or a blocking timeout of the task expires.
  */
-void osDelayCount(void)
+static void taskTimeoutCallback(void* arg)
 {
-	osTaskObject *task = NULL;
-	
-	/* Find the task */
-	for (u8 i = 0; i < osTasksCreated; i++)
+	osTaskObject *task = (osTaskObject*)arg;
+
+	if (OS_TASK_BLOCKED == task->taskExecStatus)
 	{
-		if(OS_TASK_BLOCKED == OsKernel.osTaskList[i]->taskExecStatus && 0 != OsKernel.osTaskList[i]->delay)
-		{
-			/* Found the current task */
-			task = OsKernel.osTaskList[i];
-			task->delay--;
-			if(task->delay == 0)
-			{
-				task->taskExecStatus = OS_TASK_READY;
-			}
-		}
+		/* Whatever the task was waiting for, stop waiting. The blocking API checks again when it resumes */
+		taskSetReady(task);
 	}
 }
 
+/**
+ * @brief The task leaves the kernel: its timer, its ready list and osTaskList. From here its
+ * control block and its stack can be given to osTaskCreate again.
+ */
+static void taskRemove(osTaskObject* task)
+{
+    u32 primask = __get_PRIMASK();
+    __disable_irq();
+
+    osTimerStop(&task->timeout);
+    osSchedOnBlock(task);
+
+    if (NULL != task->taskBudget)
+    {
+        osTimerStop(&task->taskBudget->timer);
+        if (OsKernel.osBudgetChunk == task->taskBudget) OsKernel.osBudgetChunk = NULL;
+        task->taskBudget = NULL;
+    }
+
+    /* The last task of the list takes its slot, so the removal doesn't depend on the number of tasks */
+    osTasksCreated--;
+    OsKernel.osTaskList[task->taskListIndex] = OsKernel.osTaskList[osTasksCreated];
+    OsKernel.osTaskList[task->taskListIndex]->taskListIndex = task->taskListIndex;
+    OsKernel.osTaskList[osTasksCreated] = NULL;
+
+    task->taskExecStatus = OS_TASK_DELETED;
+    task->taskBlockedOn = OS_BLOCKED_NONE;
+    task->taskBlockedObject.object = NULL;
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief NULL is the calling task, which only exists once the kernel is running: before osStart
+ * there is no current task and NULL is returned.
+ */
+static osTaskObject* taskOrSelf(osTaskObject* task)
+{
+    if (NULL != task) return task;
+    if (OsKernel.osSystemStatus != OS_STATUS_RUNNING) return NULL;
+    return OsKernel.osCurrTaskCallback;
+}
+
+/**
+ * @brief Initial LR of every task, runs when the task function returns.
+ */
+static void taskExit(void)
+{
+    osTaskObject* task = OsKernel.osCurrTaskCallback;
+
+    /* IDLE can't leave, the scheduler needs it when there is nothing ready */
+    if (task != &idle)
+    {
+        osReturnTaskHook(task);
+        osTaskDelete(task);
+    }
+
+    /* PendSV is taken as soon as the IRQs are enabled (the task may have returned with them masked), the task never comes back here */
+    __enable_irq();
+    while(1)
+    {
+        __WFI();
+    }
+}
+
 
 void osDelay(const u32 tick)
 {
@@ -418,21 +1246,12 @@ void osDelay(const u32 tick)
 	{
 		osEnterCriticalSection();
 
-		osTaskObject *task = NULL;
+		osTaskObject *task = OsKernel.osCurrTaskCallback;
 
-		/* Find the task */
-		for (u8 i = 0; i < osTasksCreated; i++)
-		{
-			if(OsKernel.osTaskList[i]->taskExecStatus == OS_TASK_RUNNING)
-			{
-				/* Found the current task */
-				task = OsKernel.osTaskList[i];
-				break;
-			}
-		}
+		taskSetBlocked(task, OS_BLOCKED_NONE, NULL);
 
-		task->taskExecStatus = OS_TASK_BLOCKED;
-		task->delay=tick;
+		/* MAX_DELAY blocks the task forever */
+		if (tick != MAX_DELAY) osTimerStart(&task->timeout, tick, 0);
 
 		osYield();
 
@@ -447,9 +1266,7 @@ void blockTaskFromSem(osSemaphoreObject* sem)
     task = findRunningTask();
     if (task != NULL)
     {
-    	task->sem = sem;
-        task->semBlocked = true;
-        task->taskExecStatus = OS_TASK_BLOCKED;
+        taskSetBlocked(task, OS_BLOCKED_SEMAPHORE, sem);
     }
     osYield();
 }
@@ -457,27 +1274,24 @@ void blockTaskFromSem(osSemaphoreObject* sem)
 void checkBlockedTaskFromSem(osSemaphoreObject *sem)
 {
     osTaskObject *task = NULL;
-    task = findBlockedTaskFromSemaphore(sem);
+    task = findBlockedTask(OS_BLOCKED_SEMAPHORE, sem);
     if (task != NULL)
     {
-        task->taskExecStatus = OS_TASK_READY;
-        task->semBlocked = false;
-    	task->sem = NULL;
+        osTimerStop(&task->timeout);
+        taskSetReady(task);
     }
     osYield();
 }
 
-void blockTaskFromQueue(osQueueObject *queue, u8 sender)
+void blockTaskFromQueue(osQueueObject *queue, u8 sender, u32 timeout)
 {
     osTaskObject *task = NULL;
     task = findRunningTask();
     if (task != NULL)
     {
-        if(sender)  task->queueBlockedFromFull = true;    // If this comes from a QueueSend
-        else        task->queueBlockedFromEmpty = true;   // If this comes from a QueueReceive
-        if(sender)  task->queueFull  = queue;             // This is the queue that is causing the Full blocking
-        else        task->queueEmpty = queue;             // This is the queue that is causing the Empty blocking
-        task->taskExecStatus = OS_TASK_BLOCKED;
+        /* A QueueSend waits for the queue to have place, a QueueReceive for it to have data */
+        taskSetBlocked(task, sender ? OS_BLOCKED_QUEUE_FULL : OS_BLOCKED_QUEUE_EMPTY, queue);
+        if (timeout != MAX_DELAY) osTimerStart(&task->timeout, timeout, 0);
     }
     osYield();
 }
@@ -485,63 +1299,53 @@ void blockTaskFromQueue(osQueueObject *queue, u8 sender)
 void checkBlockedTaskFromQueue(osQueueObject *queue, u8 sender)
 {
     osTaskObject *task = NULL;
-    task = findBlockedTaskFromQueue(sender);
+    /* A QueueSend wakes up a receiver of the queue, a QueueReceive a sender */
+    task = findBlockedTask(sender ? OS_BLOCKED_QUEUE_EMPTY : OS_BLOCKED_QUEUE_FULL, queue);
     if (task != NULL)
     {
-        task->taskExecStatus = OS_TASK_READY;
-        if (sender) task->queueBlockedFromEmpty = false;
-        else        task->queueBlockedFromFull  = false;
-        if (sender) task->queueFull = NULL;
-        else        task->queueEmpty= NULL;
+        osTimerStop(&task->timeout);
+        taskSetReady(task);
     }
     osYield();
 }
 
-osTaskObject* findBlockedTaskFromQueue(u8 sender)
+void blockTaskFromPool(osPoolObject *pool, u32 timeout)
 {
-    /* Find the task */
-    for (u8 i = 0; i < osTasksCreated; i++)
+    osTaskObject *task = NULL;
+    task = findRunningTask();
+    if (task != NULL)
     {
-        if( OsKernel.osTaskList[i]->taskExecStatus == OS_TASK_BLOCKED)
-        {
-            switch(sender)
-            {
-                case 0:
-                {
-                    if (OsKernel.osTaskList[i]->queueBlockedFromFull == true)
-                    {
-                        return OsKernel.osTaskList[i];
-                    }
-                }
-                break;
+        taskSetBlocked(task, OS_BLOCKED_POOL, pool);
+        if (timeout != MAX_DELAY) osTimerStart(&task->timeout, timeout, 0);
+    }
+    osYield();
+}
 
-                case 1:
-                {
-                    if (OsKernel.osTaskList[i]->queueBlockedFromEmpty == true)
-                    {
-                        return OsKernel.osTaskList[i];
-                    }
-                }
-                break;
-            }
-        }
+void checkBlockedTaskFromPool(osPoolObject *pool)
+{
+    osTaskObject *task = NULL;
+    task = findBlockedTask(OS_BLOCKED_POOL, pool);
+    if (task != NULL)
+    {
+        osTimerStop(&task->timeout);
+        taskSetReady(task);
+        osYield();
     }
-    return NULL;
 }
 
-osTaskObject* findBlockedTaskFromSemaphore(osSemaphoreObject *sem)
+/**
+ * @brief First task of the list of tasks blocked on the object (creation order until a task is deleted).
+ */
+static osTaskObject* findBlockedTask(osBlockedOnType on, const void* object)
 {
-	osTaskObject *task = NULL;
     /* Find the task */
     for (u8 i = 0; i < osTasksCreated; i++)
     {
-        if( OsKernel.osTaskList[i]->taskExecStatus == OS_TASK_BLOCKED)
+        if (OsKernel.osTaskList[i]->taskExecStatus == OS_TASK_BLOCKED &&
+            OsKernel.osTaskList[i]->taskBlockedOn == on &&
+            OsKernel.osTaskList[i]->taskBlockedObject.object == object)
         {
-            if (OsKernel.osTaskList[i]->semBlocked == true && OsKernel.osTaskList[i]->sem == sem)
-            {
-            	task = OsKernel.osTaskList[i];
-                return task;
-            }
+            return OsKernel.osTaskList[i];
         }
     }
     return NULL;
@@ -550,18 +1354,9 @@ osTaskObject* findBlockedTaskFromSemaphore(osSemaphoreObject *sem)
 
 osTaskObject* findRunningTask(void)
 {
-    osTaskObject *task = NULL;
-    /* Find the task */
-    for (u8 i = 0; i < osTasksCreated; i++)
-    {
-        if(OsKernel.osTaskList[i]->taskExecStatus == OS_TASK_RUNNING)
-        {
-            /* Found the current task */
-            task = OsKernel.osTaskList[i];
-            return task;
-        }
-    }
-    return task;
+    /* IDLE never blocks, it can't use the blocking APIs */
+    if (OsKernel.osCurrTaskCallback == &idle) return NULL;
+    return OsKernel.osCurrTaskCallback;
 }
 
 
@@ -576,12 +1371,253 @@ void osYield(void)
 	if (osGetStatus() == OS_STATUS_RUNNING)
 	{
 		scheduler();
-		SCB->ICSR = SCB_ICSR_PENDSVSET_Msk;
+		requestContextSwitch(false);
 		__ISB();
 		__DSB();
 	}
 }
 
+void osTaskSetName(osTaskObject* task, const char* name)
+{
+	u32 i = 0;
+
+	if (NULL == task || NULL == name) return;
+
+	while (i < OS_MAX_TASK_NAME_CHAR - 1 && name[i] != '\0')
+	{
+		task->taskName[i] = name[i];
+		i++;
+	}
+	task->taskName[i] = '\0';
+}
+
+bool osTaskSetTimeSlice(osTaskObject* task, const u32 ticks)
+{
+	if (NULL == task) return false;
+
+	ENTER_CRITICAL_SECTION
+	task->taskTimeSlice = ticks;
+	if (task->taskSliceLeft > getTimeSlice(task)) task->taskSliceLeft = getTimeSlice(task);
+	EXIT_CRITICAL_SECTION
+
+	return true;
+}
+
+bool osTaskSetPreemptionThreshold(osTaskObject* task, const osPriorityType threshold)
+{
+	/* The threshold can only raise the priority of the task while it runs */
+	if (NULL == task || threshold > task->taskPriority) return false;
+
+	ENTER_CRITICAL_SECTION
+	task->taskPreemptThreshold = threshold;
+	EXIT_CRITICAL_SECTION
+
+	return true;
+}
+
+bool osTaskSuspend(osTaskObject* task)
+{
+	u32 primask;
+
+	task = taskOrSelf(task);
+	if (NULL == task || task == &idle) return false;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	/* Suspended by the application now, a replenishment of its budget doesn't resume it */
+	if (NULL != task->taskBudget) task->taskBudget->suspended = false;
+
+	if (OS_TASK_SUSPENDED == task->taskExecStatus || OS_TASK_DELETED == task->taskExecStatus)
+	{
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	/* Whatever it was waiting for, it stops waiting */
+	osTimerStop(&task->timeout);
+	taskSetBlocked(task, OS_BLOCKED_NONE, NULL);
+	task->taskExecStatus = OS_TASK_SUSPENDED;
+
+	osYield();
+
+	__set_PRIMASK(primask);
+	return true;
+}
+
+bool osTaskResume(osTaskObject* task)
+{
+	u32 primask;
+
+	if (NULL == task) return false;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (OS_TASK_SUSPENDED != task->taskExecStatus)
+	{
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	taskSetReady(task);
+	osYield();
+
+	__set_PRIMASK(primask);
+	return true;
+}
+
+bool osTaskDelete(osTaskObject* task)
+{
+	u32 primask;
+	bool self;
+
+	task = taskOrSelf(task);
+	if (NULL == task || task == &idle) return false;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (OS_TASK_DELETED == task->taskExecStatus)
+	{
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	/* From an IRQ the interrupted task is left when the IRQ returns */
+	self = (task == OsKernel.osCurrTaskCallback && 0 == __get_IPSR());
+	taskRemove(task);
+	osYield();
+
+	/*
+	 * PendSV is taken as soon as the IRQs are enabled, a deleted task never comes back here. A task that
+	 * deletes itself inside a critical section would keep them masked and spin forever: its critical
+	 * section ends with it, so the IRQs are enabled.
+	 */
+	if (self)
+	{
+		__enable_irq();
+		while (1)
+		{
+			__WFI();
+		}
+	}
+
+	__set_PRIMASK(primask);
+
+	return true;
+}
+
+bool osTaskSetPriority(osTaskObject* task, const osPriorityType priority)
+{
+	u32 primask;
+	bool running;
+	bool holding;
+
+	if (NULL == task || task == &idle || (u32)priority >= OS_MAX_PRIORITY) return false;
+
+	primask = __get_PRIMASK();
+	__disable_irq();
+
+	if (OS_TASK_DELETED == task->taskExecStatus)
+	{
+		__set_PRIMASK(primask);
+		return false;
+	}
+
+	/* The priority set now is kept when the budget of the task is replenished */
+	if (NULL != task->taskBudget) task->taskBudget->demoted = false;
+
+	/* A task preempted after its dispatch still holds its threshold, until it blocks */
+	running = (task == OsKernel.osCurrTaskCallback);
+	holding = running || task->taskRunPriority != task->taskPriority;
+
+	/* Without threshold it follows the priority, with one it can't be below the priority */
+	if (task->taskPreemptThreshold == task->taskPriority || task->taskPreemptThreshold > priority)
+	{
+		task->taskPreemptThreshold = priority;
+	}
+	task->taskPriority = priority;
+
+	if (NULL != task->readyNext)
+	{
+		/*
+		 * The running task competes with its threshold. A preempted one keeps the level it holds, only
+		 * raised if the new priority is higher. Both stay the head of their list.
+		 */
+		osSchedOnBlock(task);
+		if (running) task->taskRunPriority = task->taskPreemptThreshold;
+		else if (!holding || task->taskRunPriority > priority) task->taskRunPriority = priority;
+		osSchedOnReady(task, holding);
+	}
+	else
+	{
+		task->taskRunPriority = task->taskPriority;
+	}
+
+	osYield();
+
+	__set_PRIMASK(primask);
+	return true;
+}
+
+u32 osGetTick(void)
+{
+	return osTimerNow();
+}
+
+u32 osTaskGetStackHighWater(const osTaskObject* task)
+{
+	u32 words = task->taskStackSize / 4;
+	u32 unused = 0;
+
+	/* The stack grows down, count the painted words from the bottom */
+	while (unused < words && task->taskStack[unused] == OS_STACK_FILL_PATTERN)
+	{
+		unused++;
+	}
+
+	return (words - unused) * 4;
+}
+
+void osGetStats(osKernelStats* stats)
+{
+	if (NULL == stats) return;
+
+	ENTER_CRITICAL_SECTION
+	stats->ticks = osTimerNow();
+	stats->switches = OsKernel.osSwitchCount;
+	stats->switchesAvoided = OsKernel.osSwitchAvoided;
+	EXIT_CRITICAL_SECTION
+}
+
+osErrorType osGetLastError(void)
+{
+	return (osErrorType)OsKernel.osLastError;
+}
+
+bool osStackGuardFault(void)
+{
+#if OS_USE_MPU_STACK_GUARD
+	osTaskObject* task = OsKernel.osCurrTaskCallback;
+	u32 cfsr = SCB->CFSR;
+	u32 guard;
+
+	if (NULL == task) return false;
+	guard = task->taskStackGuard & MPU_RBAR_ADDR_Msk;
+
+	/* Stacking errors on entry to an exception or a data access inside the guard */
+	if ((cfsr & SCB_CFSR_MSTKERR_Msk) != 0 ||
+		((cfsr & SCB_CFSR_MMARVALID_Msk) != 0 && SCB->MMFAR - guard < OS_MPU_GUARD_SIZE))
+	{
+		OsKernel.osLastError = OS_ERROR_STACK_OVERFLOW;
+		osErrorHook(task);
+		return true;
+	}
+#endif
+	return false;
+}
+
 bool osGetYieldFlag(void)
 {
 	return OsKernel.yieldFromIsr;
@@ -615,12 +1651,8 @@ void osExitCriticalSection(void)
 
 
 /* -----------------------------  Weak functions ----------------------------------- */
-WEAK void osReturnTaskHook(void)
+WEAK void osReturnTaskHook(osTaskObject* task)
 {
-    while(1)
-    {
-        __WFI();
-    }
 }
 
 
@@ -638,6 +1670,16 @@ WEAK void osErrorHook(void* caller)
 }
 
 
+WEAK void osDeadlineMissHook(osTaskObject* task)
+{
+}
+
+
+WEAK void osBudgetOverrunHook(osTaskObject* task)
+{
+}
+
+
 WEAK void osIdleTask(void)
 {
    /*TODO: Blink LED */
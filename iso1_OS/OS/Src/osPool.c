@@ -0,0 +1,139 @@
+#include "osPool.h"
+#include "osKernel.h"
+#include "osTimer.h"
+
+bool osPoolInit(osPoolObject* pool, void* buffer, const u32 blockSize, const u32 blockCount)
+{
+    u8* block;
+
+    if (NULL == pool || NULL == buffer || 0 == blockSize || 0 == blockCount) return false;
+
+    /* The blocks store a pointer when they are free */
+    if (((u32)buffer & 0x3U) != 0) return false;
+
+    pool->buffer = (u8*)buffer;
+    pool->blockSize = OS_POOL_BLOCK_SIZE(blockSize);
+    pool->blockCount = blockCount;
+    pool->used = 0;
+    pool->highWater = 0;
+    pool->failures = 0;
+
+    /* Chain all the blocks, the last one points to NULL */
+    block = pool->buffer;
+    for (u32 i = 0; i < blockCount - 1; i++)
+    {
+        *(void**)block = block + pool->blockSize;
+        block += pool->blockSize;
+    }
+    *(void**)block = NULL;
+    pool->freeList = pool->buffer;
+
+    return true;
+}
+
+void* osPoolAlloc(osPoolObject* pool, const u32 timeout)
+{
+    void* block = NULL;
+    u32 primask;
+    u32 deadline;
+    u32 left = timeout;
+    i32 remaining;
+
+    if (NULL == pool) return NULL;
+
+    deadline = osTimerNow() + timeout;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /*
+     * Pool is EMPTY, block the task until a block is given back or the timeout expires. Another task can
+     * take the block given back before the woken one runs, then it waits again for the time left.
+     * A caller with the IRQs masked can't be switched out, so it never blocks.
+     */
+    while (NULL == pool->freeList && 0 != left && 0 == primask && osGetStatus() == OS_STATUS_RUNNING)
+    {
+        blockTaskFromPool(pool, left);
+
+        /* PendSV switches to another task here, this one comes back when it is woken or on its timeout */
+        __set_PRIMASK(primask);
+        __disable_irq();
+
+        if (MAX_DELAY != timeout)
+        {
+            remaining = (i32)(deadline - osTimerNow());
+            left = (remaining > 0) ? (u32)remaining : 0;
+        }
+    }
+
+    block = pool->freeList;
+    if (NULL != block)
+    {
+        pool->freeList = *(void**)block;
+        pool->used++;
+        if (pool->used > pool->highWater) pool->highWater = pool->used;
+    }
+    else
+    {
+        pool->failures++;
+    }
+
+    __set_PRIMASK(primask);
+
+    return block;
+}
+
+bool osPoolFree(osPoolObject* pool, void* block)
+{
+    u32 offset;
+    u32 primask;
+
+    if (NULL == pool || NULL == block) return false;
+
+    /* Only blocks of this pool can be given back */
+    offset = (u32)((u8*)block - pool->buffer);
+    if ((u8*)block < pool->buffer || offset >= pool->blockSize * pool->blockCount || (offset % pool->blockSize) != 0)
+    {
+        return false;
+    }
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+#if OS_USE_POOL_CHECK
+    /* A block given back twice would make a cycle on the free list */
+    for (void* free = pool->freeList; NULL != free; free = *(void**)free)
+    {
+        if (free == block)
+        {
+            __set_PRIMASK(primask);
+            return false;
+        }
+    }
+#endif
+
+    *(void**)block = pool->freeList;
+    pool->freeList = block;
+    pool->used--;
+
+    /*
+     * One waiter is woken for every block given back. Checking only when the pool stops being empty
+     * loses wakeups: two frees before the first woken task runs would leave the second waiter blocked.
+     */
+    checkBlockedTaskFromPool(pool);
+
+    __set_PRIMASK(primask);
+
+    return true;
+}
+
+void osPoolGetStats(const osPoolObject* pool, osPoolStats* stats)
+{
+    if (NULL == pool || NULL == stats) return;
+
+    stats->blockSize = pool->blockSize;
+    stats->blockCount = pool->blockCount;
+    stats->used = pool->used;
+    stats->highWater = pool->highWater;
+    stats->failures = pool->failures;
+}
@@ -39,10 +39,10 @@ bool osQueueSend(osQueueObject* queue, const void* data, const u32 timeout)
 {
 	bool ret = false;
     /* Queue is FULL we need to block the task until there is a place in the queue*/
-    if (queue->size >= MAX_SIZE_QUEUE && osGetStatus() == OS_STATUS_RUNNING)
+    if (queue->size >= MAX_SIZE_QUEUE && timeout != 0 && osGetStatus() == OS_STATUS_RUNNING)
     {
     	osEnterCriticalSection();
-        blockTaskFromQueue(queue, 1); // 1 means that is blocking from the sender
+        blockTaskFromQueue(queue, 1, timeout); // 1 means that is blocking from the sender
         osExitCriticalSection();
     }
 
@@ -69,10 +69,11 @@ bool osQueueSend(osQueueObject* queue, const void* data, const u32 timeout)
 
 bool osQueueReceive(osQueueObject* queue, void* buffer, const u32 timeout)
 {
-	if (queue->size == 0 && osGetStatus() == OS_STATUS_RUNNING)
+	bool ret = false;
+	if (queue->size == 0 && timeout != 0 && osGetStatus() == OS_STATUS_RUNNING)
 	{
 		ENTER_CRITICAL_SECTION
-		blockTaskFromQueue(queue,0); // 0 means that is blocking form receiver
+		blockTaskFromQueue(queue, 0, timeout); // 0 means that is blocking form receiver
 		EXIT_CRITICAL_SECTION
 	}
 
@@ -88,7 +89,8 @@ bool osQueueReceive(osQueueObject* queue, void* buffer, const u32 timeout)
 
         if (queue->size == MAX_SIZE_QUEUE - 1) checkBlockedTaskFromQueue(queue, 0); // Check only in the limit
         EXIT_CRITICAL_SECTION
+		ret = true;
     }
 
-    return true;
+    return ret;
 }
@@ -0,0 +1,92 @@
+#include "osSched.h"
+
+#ifdef OS_WITH_EDF
+
+/*
+ * Earliest deadline first: the tasks with deadline (periodic tasks and osTaskSetDeadline) are kept
+ * in one circular list ordered by absolute deadline, its head runs. The tasks without deadline run
+ * by fixed priority when none of them is ready.
+ * Insertion walks the list (O(n)), pick and removal are O(1).
+ */
+
+static osTaskObject* edfList OS_CCMRAM;         // Earliest absolute deadline first
+static osReadyQueue ready OS_CCMRAM;            // Tasks without deadline
+
+
+void osSchedOnReady(osTaskObject* task, bool head)
+{
+    osTaskObject* first = edfList;
+    osTaskObject* pos = first;
+
+    /* The tasks with deadline are ordered by it, head doesn't apply */
+    if (0 == task->taskDeadline)
+    {
+        osReadyQueueInsert(&ready, task, head);
+        return;
+    }
+
+    if (NULL == first)
+    {
+        task->readyNext = task;
+        task->readyPrev = task;
+        edfList = task;
+        return;
+    }
+
+    /*
+     * First task with a later deadline, the comparison handles the wrap of the tick.
+     * The task goes after the ones with its same deadline, so a new job never preempts another one with its same deadline.
+     */
+    do
+    {
+        if ((i32)(pos->taskAbsDeadline - task->taskAbsDeadline) > 0) break;
+        pos = pos->readyNext;
+    } while (pos != first);
+
+    task->readyNext = pos;
+    task->readyPrev = pos->readyPrev;
+    pos->readyPrev->readyNext = task;
+    pos->readyPrev = task;
+
+    if (pos == first && (i32)(first->taskAbsDeadline - task->taskAbsDeadline) > 0) edfList = task;
+}
+
+void osSchedOnBlock(osTaskObject* task)
+{
+    if (NULL == task->readyNext) return;
+
+    if (0 == task->taskDeadline)
+    {
+        osReadyQueueRemove(&ready, task);
+        return;
+    }
+
+    if (task->readyNext == task)
+    {
+        edfList = NULL;
+    }
+    else
+    {
+        task->readyPrev->readyNext = task->readyNext;
+        task->readyNext->readyPrev = task->readyPrev;
+        if (edfList == task) edfList = task->readyNext;
+    }
+
+    task->readyNext = NULL;
+    task->readyPrev = NULL;
+}
+
+osTaskObject* osSchedPickNext(const osTaskObject* curr)
+{
+    /* The deadline ordered list is never rotated */
+    if (NULL != edfList) return edfList;
+    return osReadyQueueBest(&ready, curr);
+}
+
+void osSchedOnDispatch(osTaskObject* task)
+{
+    /* The tasks with deadline don't use the preemption threshold, their list is not by priority */
+    if (0 == task->taskDeadline) osReadyQueueDispatch(&ready, task);
+}
+
+#endif // OS_WITH_EDF
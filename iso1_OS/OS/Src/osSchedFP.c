@@ -0,0 +1,33 @@
+#include "osSched.h"
+
+#ifdef OS_WITH_PRIORITY
+
+/*
+ * Fixed priority: the head of the highest priority ready list runs, the tasks of the same
+ * priority share the CPU by round-robin with their slices.
+ */
+
+static osReadyQueue ready OS_CCMRAM;
+
+
+void osSchedOnReady(osTaskObject* task, bool head)
+{
+    osReadyQueueInsert(&ready, task, head);
+}
+
+void osSchedOnBlock(osTaskObject* task)
+{
+    osReadyQueueRemove(&ready, task);
+}
+
+osTaskObject* osSchedPickNext(const osTaskObject* curr)
+{
+    return osReadyQueueBest(&ready, curr);
+}
+
+void osSchedOnDispatch(osTaskObject* task)
+{
+    osReadyQueueDispatch(&ready, task);
+}
+
+#endif // OS_WITH_PRIORITY
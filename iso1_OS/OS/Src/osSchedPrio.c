@@ -0,0 +1,80 @@
+#include "osSched.h"
+
+/* Bit of a priority in the ready bitmap: priority 0 is bit 31, so CLZ gives the highest priority ready */
+#define OS_READY_BIT(prio)      (0x80000000U >> (prio))
+
+
+void osReadyQueueInsert(osReadyQueue* ready, osTaskObject* task, bool head)
+{
+    u32 prio = task->taskRunPriority;
+    osTaskObject* first = ready->list[prio];
+
+    if (NULL == first)
+    {
+        task->readyNext = task;
+        task->readyPrev = task;
+        ready->list[prio] = task;
+        ready->bitmap |= OS_READY_BIT(prio);
+        return;
+    }
+
+    task->readyNext = first;
+    task->readyPrev = first->readyPrev;
+    first->readyPrev->readyNext = task;
+    first->readyPrev = task;
+
+    if (head) ready->list[prio] = task;
+}
+
+void osReadyQueueRemove(osReadyQueue* ready, osTaskObject* task)
+{
+    u32 prio = task->taskRunPriority;
+
+    if (NULL == task->readyNext) return;
+
+    if (task->readyNext == task)
+    {
+        ready->list[prio] = NULL;
+        ready->bitmap &= ~OS_READY_BIT(prio);
+    }
+    else
+    {
+        task->readyPrev->readyNext = task->readyNext;
+        task->readyNext->readyPrev = task->readyPrev;
+        if (ready->list[prio] == task) ready->list[prio] = task->readyNext;
+    }
+
+    task->readyNext = NULL;
+    task->readyPrev = NULL;
+}
+
+osTaskObject* osReadyQueueBest(osReadyQueue* ready, const osTaskObject* curr)
+{
+    osTaskObject* next;
+
+    if (0 == ready->bitmap) return NULL;
+
+    next = ready->list[__CLZ(ready->bitmap)];
+
+    /*
+     * The running task is always the head of its list. When its slice is over it goes to the
+     * tail, unless it runs above its priority (preemption threshold): then it is not rotated.
+     */
+    if (next == curr && 0 == curr->taskSliceLeft && curr->taskRunPriority == curr->taskPriority)
+    {
+        next = curr->readyNext;
+        ready->list[curr->taskRunPriority] = next;
+    }
+
+    return next;
+}
+
+void osReadyQueueDispatch(osReadyQueue* ready, osTaskObject* task)
+{
+    if (task->taskRunPriority != task->taskPreemptThreshold)
+    {
+        osReadyQueueRemove(ready, task);
+        task->taskRunPriority = task->taskPreemptThreshold;
+        osReadyQueueInsert(ready, task, true);
+    }
+}
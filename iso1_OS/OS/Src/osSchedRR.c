@@ -0,0 +1,58 @@
+#include "osSched.h"
+
+#ifdef OS_SIMPLE
+
+/*
+ * Round-robin: the ready tasks share the CPU in one circular list, without priorities.
+ * The head runs, and goes to the tail when its slice is over.
+ */
+
+static osTaskObject* ring OS_CCMRAM;            // Head of the circular list of the ready tasks
+
+
+void osSchedOnReady(osTaskObject* task, bool head)
+{
+    osTaskObject* first = ring;
+
+    if (NULL == first)
+    {
+        task->readyNext = task;
+        task->readyPrev = task;
+        ring = task;
+        return;
+    }
+
+    task->readyNext = first;
+    task->readyPrev = first->readyPrev;
+    first->readyPrev->readyNext = task;
+    first->readyPrev = task;
+
+    if (head) ring = task;
+}
+
+void osSchedOnBlock(osTaskObject* task)
+{
+    if (NULL == task->readyNext) return;
+
+    if (task->readyNext == task)
+    {
+        ring = NULL;
+    }
+    else
+    {
+        task->readyPrev->readyNext = task->readyNext;
+        task->readyNext->readyPrev = task->readyPrev;
+        if (ring == task) ring = task->readyNext;
+    }
+
+    task->readyNext = NULL;
+    task->readyPrev = NULL;
+}
+
+osTaskObject* osSchedPickNext(const osTaskObject* curr)
+{
+    if (NULL != ring && ring == curr && 0 == curr->taskSliceLeft) ring = curr->readyNext;
+    return ring;
+}
+
+#endif // OS_SIMPLE
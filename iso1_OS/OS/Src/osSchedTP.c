@@ -0,0 +1,90 @@
+#include "osSched.h"
+
+#ifdef OS_WITH_TIME_PARTITION
+
+/*
+ * Time partitions: a cyclic table of minor frames gives the CPU to one partition at a time, and
+ * inside it the ready tasks of the partition are scheduled by fixed priority.
+ */
+
+/* Cyclic table of minor frames, repeated from osStart. Its length is the major frame */
+static const osMinorFrame osPartitionTable[] = OS_PARTITION_TABLE;
+#define OS_PARTITION_FRAMES     (sizeof(osPartitionTable) / sizeof(osPartitionTable[0]))
+
+static osReadyQueue ready[OS_PARTITIONS] OS_CCMRAM;    // Ready lists of every partition
+static u8 activePartition OS_CCMRAM;                    // Partition of the current minor frame, OS_PARTITION_NONE runs IDLE
+static u32 frameIndex OS_CCMRAM;                        // Current minor frame of osPartitionTable
+static u32 frameLeft OS_CCMRAM;                         // Ticks left of the current minor frame
+
+
+bool osSchedInit(void)
+{
+    /* A frame of 0 ticks would make frameLeft wrap and give the CPU to its partition for 2^32 ticks */
+    for (u32 i = 0; i < OS_PARTITION_FRAMES; i++)
+    {
+        if (0 == osPartitionTable[i].ticks) return false;
+    }
+
+    /* The major frame starts with osStart */
+    frameIndex = 0;
+    activePartition = osPartitionTable[0].partition;
+    frameLeft = osPartitionTable[0].ticks;
+    return true;
+}
+
+/**
+ * @brief Move to the next minor frame when the current one is over. Executed by SysTick before the
+ * scheduler, so the tasks of the new partition are dispatched on the tick of the frame boundary.
+ */
+void osSchedOnTick(void)
+{
+    if (--frameLeft != 0) return;
+
+    if (++frameIndex >= OS_PARTITION_FRAMES) frameIndex = 0;
+    activePartition = osPartitionTable[frameIndex].partition;
+    frameLeft = osPartitionTable[frameIndex].ticks;
+}
+
+void osSchedOnReady(osTaskObject* task, bool head)
+{
+    osReadyQueueInsert(&ready[task->taskPartition], task, head);
+}
+
+void osSchedOnBlock(osTaskObject* task)
+{
+    osReadyQueueRemove(&ready[task->taskPartition], task);
+}
+
+osTaskObject* osSchedPickNext(const osTaskObject* curr)
+{
+    if (activePartition >= OS_PARTITIONS) return NULL;
+    return osReadyQueueBest(&ready[activePartition], curr);
+}
+
+void osSchedOnDispatch(osTaskObject* task)
+{
+    osReadyQueueDispatch(&ready[task->taskPartition], task);
+}
+
+bool osTaskSetPartition(osTaskObject* task, const u8 partition)
+{
+    u32 primask;
+    bool isReady;
+
+    if (NULL == task || task == &idle || partition >= OS_PARTITIONS) return false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    /* The partition selects the ready lists, so the task leaves the ones it is in */
+    isReady = (NULL != task->readyNext);
+    osSchedOnBlock(task);
+    task->taskPartition = partition;
+    if (isReady) osSchedOnReady(task, false);
+    osYield();
+
+    __set_PRIMASK(primask);
+    return true;
+}
+
+#endif // OS_WITH_TIME_PARTITION
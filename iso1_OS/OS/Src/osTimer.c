@@ -0,0 +1,208 @@
+#include "osTimer.h"
+#include "osKernel.h"
+
+#define OS_TIMER_MAX_DELTA  ((1U << (OS_TIMER_WHEEL_BITS * OS_TIMER_WHEEL_LEVELS)) - 1U)
+
+/**
+ * @brief Timer wheel control structure.
+ * Is private to osTimer.c so is can't be manipulate from other files.
+ */
+typedef struct
+{
+    u32 now;                                                            // Last processed tick
+    osTimerObject* slots[OS_TIMER_WHEEL_LEVELS][OS_TIMER_WHEEL_SLOTS];  // Head of the list on each slot
+}osTimerWheel;
+
+static osTimerWheel wheel OS_CCMRAM;
+
+/* Private functions declarations */
+static void timerInsert(osTimerObject* timer);
+static void timerUnlink(osTimerObject* timer);
+static void timerCascade(u32 level);
+
+
+void osTimerInit(osTimerObject* timer, osTimerCallback callback, void* arg)
+{
+    if (NULL == timer) return;
+
+    timer->next = NULL;
+    timer->pprev = NULL;
+    timer->expiry = 0;
+    timer->period = 0;
+    timer->callback = callback;
+    timer->arg = arg;
+}
+
+bool osTimerStart(osTimerObject* timer, const u32 ticks, const u32 period)
+{
+    u32 primask;
+
+    if (NULL == timer || NULL == timer->callback) return false;
+
+    /* Can be called from tasks, IRQs or inside a kernel critical section, so keep the previous mask */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (NULL != timer->pprev) timerUnlink(timer);
+
+    timer->expiry = wheel.now + (ticks == 0 ? 1 : ticks);
+    timer->period = period;
+    timerInsert(timer);
+
+    __set_PRIMASK(primask);
+    return true;
+}
+
+bool osTimerStartAt(osTimerObject* timer, const u32 expiry, const u32 period)
+{
+    u32 primask;
+
+    if (NULL == timer || NULL == timer->callback) return false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (NULL != timer->pprev) timerUnlink(timer);
+
+    /* An expiry in the past would be placed a full turn ahead, fire it on the next tick instead */
+    timer->expiry = ((i32)(expiry - wheel.now) > 0) ? expiry : wheel.now + 1;
+    timer->period = period;
+    timerInsert(timer);
+
+    __set_PRIMASK(primask);
+    return true;
+}
+
+bool osTimerStop(osTimerObject* timer)
+{
+    u32 primask;
+    bool wasActive = false;
+
+    if (NULL == timer) return false;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (NULL != timer->pprev)
+    {
+        timerUnlink(timer);
+        wasActive = true;
+    }
+
+    __set_PRIMASK(primask);
+    return wasActive;
+}
+
+bool osTimerIsActive(const osTimerObject* timer)
+{
+    return (NULL != timer && NULL != timer->pprev);
+}
+
+u32 osTimerNow(void)
+{
+    return wheel.now;
+}
+
+void osTimerTick(void)
+{
+    osTimerObject* timer;
+    osTimerObject* list;
+    u32 idx;
+    u32 primask;
+
+    /* IRQs with higher priority than SysTick may arm or cancel timers while the wheel is walked */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    wheel.now++;
+    idx = wheel.now & OS_TIMER_WHEEL_MASK;
+
+    /* Every full turn of a level moves the next slot of the level above one level down */
+    if (idx == 0)
+    {
+        for (u32 level = 1; level < OS_TIMER_WHEEL_LEVELS; level++)
+        {
+            timerCascade(level);
+            if (((wheel.now >> (level * OS_TIMER_WHEEL_BITS)) & OS_TIMER_WHEEL_MASK) != 0) break;
+        }
+    }
+
+    /* Detach the current slot so callbacks can arm timers without touching the list being walked */
+    list = wheel.slots[0][idx];
+    wheel.slots[0][idx] = NULL;
+    if (NULL != list) list->pprev = &list;
+
+    while (NULL != list)
+    {
+        timer = list;
+        timerUnlink(timer);
+
+        if (timer->period != 0)
+        {
+            timer->expiry += timer->period;
+            if ((i32)(timer->expiry - wheel.now) <= 0) timer->expiry = wheel.now + 1;
+            timerInsert(timer);
+        }
+
+        timer->callback(timer->arg);
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Put the timer on the slot that matches its distance to the current tick.
+ */
+static void timerInsert(osTimerObject* timer)
+{
+    u32 delta = timer->expiry - wheel.now;
+    u32 expiry = timer->expiry;
+    u32 level = 0;
+    osTimerObject** head;
+
+    /* Too far away: park it on the last slot of the top level, it will be re-evaluated on the cascade */
+    if (delta > OS_TIMER_MAX_DELTA)
+    {
+        level = OS_TIMER_WHEEL_LEVELS - 1;
+        expiry = wheel.now + ((OS_TIMER_WHEEL_SLOTS - 1) << (level * OS_TIMER_WHEEL_BITS));
+    }
+    else
+    {
+        while (delta >= (1U << ((level + 1) * OS_TIMER_WHEEL_BITS))) level++;
+    }
+
+    head = &wheel.slots[level][(expiry >> (level * OS_TIMER_WHEEL_BITS)) & OS_TIMER_WHEEL_MASK];
+
+    timer->next = *head;
+    if (NULL != timer->next) timer->next->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+}
+
+static void timerUnlink(osTimerObject* timer)
+{
+    *timer->pprev = timer->next;
+    if (NULL != timer->next) timer->next->pprev = timer->pprev;
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/**
+ * @brief Move every timer of the current slot of a level to the lower levels.
+ */
+static void timerCascade(u32 level)
+{
+    u32 idx = (wheel.now >> (level * OS_TIMER_WHEEL_BITS)) & OS_TIMER_WHEEL_MASK;
+    osTimerObject* list = wheel.slots[level][idx];
+    osTimerObject* timer;
+
+    wheel.slots[level][idx] = NULL;
+    if (NULL != list) list->pprev = &list;
+
+    while (NULL != list)
+    {
+        timer = list;
+        timerUnlink(timer);
+        timerInsert(timer);
+    }
+}
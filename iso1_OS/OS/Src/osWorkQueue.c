@@ -0,0 +1,121 @@
+#include "osWorkQueue.h"
+#include "osSemaphore.h"
+
+/**
+ * @brief Work queue control structure.
+ * Is private to osWorkQueue.c so is can't be manipulate from other files.
+ */
+typedef struct
+{
+    osWorkObject* head;             // First work to execute
+    osWorkObject* tail;             // Last work submitted
+    osSemaphoreObject signal;       // Given on every submission, taken by the worker
+    osTaskObject worker;            // Worker task
+    osBudgetObject budget;          // Budget of the worker when it is a server
+}osWorkQueueCtrl;
+
+static osWorkQueueCtrl workQueue OS_CCMRAM;
+static OS_TASK_STACK_DEFINE(workerStack, OS_WORKQUEUE_STACK_SIZE) OS_CCMRAM;
+
+/* Private functions declarations */
+static void workerTask(void* arg);
+static osWorkObject* workPop(void);
+
+
+bool osWorkQueueInit(osPriorityType priority)
+{
+    workQueue.head = NULL;
+    workQueue.tail = NULL;
+    osSemaphoreInit(&workQueue.signal, 1, 0);
+
+    return osTaskCreate(&workQueue.worker, priority, workerTask, NULL, OS_TASK_STACK(workerStack));
+}
+
+bool osWorkQueueSetServer(uint32_t budget, uint32_t period, osBudgetReplenishType replenish)
+{
+    return osTaskSetBudget(&workQueue.worker, &workQueue.budget, budget, period, OS_BUDGET_SUSPEND, replenish);
+}
+
+void osWorkInit(osWorkObject* work, osWorkFunction function, void* arg)
+{
+    if (NULL == work) return;
+
+    work->next = NULL;
+    work->function = function;
+    work->arg = arg;
+    work->pending = false;
+    work->coalesced = 0;
+}
+
+bool osWorkSubmit(osWorkObject* work)
+{
+    u32 primask;
+
+    if (NULL == work || NULL == work->function) return false;
+
+    /* Called from IRQs and tasks, keep the previous mask */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    if (work->pending)
+    {
+        work->coalesced++;
+        __set_PRIMASK(primask);
+        return false;
+    }
+
+    work->pending = true;
+    work->next = NULL;
+    if (NULL == workQueue.tail) workQueue.head = work;
+    else                        workQueue.tail->next = work;
+    workQueue.tail = work;
+
+    __set_PRIMASK(primask);
+
+    /* Wake up the worker. From an IRQ the context change is done when the IRQ returns */
+    osSemaphoreGive(&workQueue.signal);
+
+    return true;
+}
+
+/**
+ * @brief Worker task. Executes all the pending work every time it is signaled.
+ */
+static void workerTask(void* arg)
+{
+    osWorkObject* work;
+
+    while(1)
+    {
+        osSemaphoreTake(&workQueue.signal);
+
+        while (NULL != (work = workPop()))
+        {
+            work->function(work->arg);
+        }
+    }
+}
+
+/**
+ * @brief Take the first pending work. It is marked as not pending before being executed,
+ * so a submission done while it runs queues it again.
+ */
+static osWorkObject* workPop(void)
+{
+    osWorkObject* work;
+
+    osEnterCriticalSection();
+
+    work = workQueue.head;
+    if (NULL != work)
+    {
+        workQueue.head = work->next;
+        if (NULL == workQueue.head) workQueue.tail = NULL;
+        work->next = NULL;
+        work->pending = false;
+    }
+
+    osExitCriticalSection();
+
+    return work;
+}